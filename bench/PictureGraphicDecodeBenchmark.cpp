@@ -0,0 +1,97 @@
+/*******************************************************************************
+** @file       PictureGraphicDecodeBenchmark.cpp
+** @author     The Open-Agriculture Developers
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "JuceHeader.h"
+#include "PictureGraphicDecoder.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace
+{
+	constexpr int IMAGE_SIZE = 480;
+	constexpr int ITERATIONS = 50;
+	constexpr std::uint8_t TRANSPARENCY_COLOUR = 0;
+
+	/// @brief The per pixel decode that PictureGraphicComponent used before the lookup table
+	void decode_per_pixel(const std::vector<std::uint8_t> &pixelData, std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, Image &destination)
+	{
+		std::size_t pixelIndex = 0;
+
+		for (int i = 0; i < destination.getHeight(); i++)
+		{
+			for (int j = 0; j < destination.getWidth(); j++)
+			{
+				auto vtColour = workingSet->get_colour(pixelData.at(pixelIndex));
+				destination.setPixelAt(j, i, Colour(Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, pixelData.at(pixelIndex) == TRANSPARENCY_COLOUR ? 0.0f : 1.0f)));
+				pixelIndex++;
+			}
+		}
+	}
+
+	/// @brief The row based decode using a lookup table, including building the table
+	void decode_with_lookup_table(const std::vector<std::uint8_t> &pixelData, std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, Image &destination)
+	{
+		auto lookupTable = PictureGraphicDecoder::create_lookup_table(workingSet);
+		PictureGraphicDecoder::set_transparent_colour(lookupTable, TRANSPARENCY_COLOUR);
+		PictureGraphicDecoder::decode_indexed_pixels(pixelData.data(), pixelData.size(), lookupTable, destination);
+	}
+
+	template<typename DecodeFunction>
+	double time_decode_ms(DecodeFunction decode)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < ITERATIONS; i++)
+		{
+			decode();
+		}
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		return elapsed.count() / ITERATIONS;
+	}
+}
+
+int main()
+{
+	ScopedJuceInitialiser_GUI juceInitialiser;
+	auto workingSet = std::make_shared<isobus::VirtualTerminalServerManagedWorkingSet>(nullptr);
+	std::vector<std::uint8_t> pixelData(IMAGE_SIZE * IMAGE_SIZE);
+	std::mt19937 generator(42);
+	std::uniform_int_distribution<int> paletteIndex(0, 255);
+
+	for (auto &pixel : pixelData)
+	{
+		pixel = static_cast<std::uint8_t>(paletteIndex(generator));
+	}
+
+	Image perPixelImage(Image::PixelFormat::ARGB, IMAGE_SIZE, IMAGE_SIZE, true);
+	Image lookupTableImage(Image::PixelFormat::ARGB, IMAGE_SIZE, IMAGE_SIZE, true);
+
+	auto perPixelTime = time_decode_ms([&]() { decode_per_pixel(pixelData, workingSet, perPixelImage); });
+	auto lookupTableTime = time_decode_ms([&]() { decode_with_lookup_table(pixelData, workingSet, lookupTableImage); });
+
+	bool imagesMatch = true;
+	for (int y = 0; (y < IMAGE_SIZE) && imagesMatch; y++)
+	{
+		for (int x = 0; x < IMAGE_SIZE; x++)
+		{
+			if (perPixelImage.getPixelAt(x, y) != lookupTableImage.getPixelAt(x, y))
+			{
+				imagesMatch = false;
+				break;
+			}
+		}
+	}
+
+	std::cout << "Picture graphic decode, " << IMAGE_SIZE << "x" << IMAGE_SIZE << " 8 bit, average of " << ITERATIONS << " runs" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "  per pixel setPixelAt: " << perPixelTime << " ms" << std::endl;
+	std::cout << "  lookup table rows:    " << lookupTableTime << " ms" << std::endl;
+	std::cout << "  speedup:              " << (perPixelTime / lookupTableTime) << "x" << std::endl;
+	std::cout << "  output identical:     " << (imagesMatch ? "yes" : "NO") << std::endl;
+	return imagesMatch ? 0 : 1;
+}
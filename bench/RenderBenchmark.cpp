@@ -0,0 +1,367 @@
+/*******************************************************************************
+** @file       RenderBenchmark.cpp
+** @author     The Open-Agriculture Developers
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "JuceHeader.h"
+#include "JuceManagedWorkingSetCache.hpp"
+#include "ObjectPoolStorage.hpp"
+#include "PictureGraphicCache.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+namespace
+{
+	// Every allocation carries a small header with its size, so that the current and peak
+	// number of allocated bytes can be tracked without any platform specific heap APIs.
+	constexpr std::size_t ALLOCATION_HEADER_SIZE = alignof(std::max_align_t);
+	constexpr int DEFAULT_ITERATIONS = 5;
+
+	std::atomic<std::size_t> allocationCount{ 0 };
+	std::atomic<std::size_t> allocatedBytes{ 0 };
+	std::atomic<std::size_t> peakAllocatedBytes{ 0 };
+
+	void *tracked_allocate(std::size_t size) noexcept
+	{
+		void *retVal = nullptr;
+		auto block = static_cast<std::uint8_t *>(std::malloc(size + ALLOCATION_HEADER_SIZE));
+
+		if (nullptr != block)
+		{
+			*reinterpret_cast<std::size_t *>(block) = size;
+			allocationCount++;
+			auto currentBytes = allocatedBytes.fetch_add(size) + size;
+			auto peakBytes = peakAllocatedBytes.load();
+
+			while ((currentBytes > peakBytes) && (!peakAllocatedBytes.compare_exchange_weak(peakBytes, currentBytes)))
+			{
+			}
+			retVal = block + ALLOCATION_HEADER_SIZE;
+		}
+		return retVal;
+	}
+
+	void tracked_free(void *pointer) noexcept
+	{
+		if (nullptr != pointer)
+		{
+			auto block = static_cast<std::uint8_t *>(pointer) - ALLOCATION_HEADER_SIZE;
+			allocatedBytes -= *reinterpret_cast<std::size_t *>(block);
+			std::free(block);
+		}
+	}
+
+	/// @brief The cost of building and painting one mask
+	struct MaskResult
+	{
+		std::uint16_t objectID = 0;
+		String typeName;
+		double buildTimeMs = 0.0;
+		double paintTimeMs = 0.0;
+		std::size_t allocations = 0;
+		std::size_t peakBytes = 0;
+		bool built = false;
+	};
+
+	/// @brief One object pool to load, made of one or more files
+	struct PoolSource
+	{
+		String name;
+		std::vector<std::vector<std::uint8_t>> rawData;
+	};
+
+	String get_mask_type_name(isobus::VirtualTerminalObjectType type)
+	{
+		switch (type)
+		{
+			case isobus::VirtualTerminalObjectType::DataMask:
+				return "DataMask";
+
+			case isobus::VirtualTerminalObjectType::AlarmMask:
+				return "AlarmMask";
+
+			case isobus::VirtualTerminalObjectType::SoftKeyMask:
+				return "SoftKeyMask";
+
+			default:
+				break;
+		}
+		return String();
+	}
+
+	std::vector<std::uint8_t> read_file(const File &file)
+	{
+		std::vector<std::uint8_t> retVal;
+		MemoryBlock contents;
+
+		if (file.loadFileAsData(contents))
+		{
+			auto data = static_cast<const std::uint8_t *>(contents.getData());
+			retVal.assign(data, data + contents.getSize());
+		}
+		return retVal;
+	}
+
+	/// @brief Finds the pools stored in an iso_data directory.
+	/// @details Versions saved by the server are loaded through ObjectPoolStorage, the same way the
+	/// server loads them, so all parts with the same label make up one pool. Any other directory
+	/// is searched for plain .iop files, and every .iop file is treated as a pool of its own.
+	std::vector<PoolSource> find_pools(const File &isoDataDirectory)
+	{
+		std::vector<PoolSource> retVal;
+		// Opened read only, since this is usually the live iso_data of an installed server
+		ObjectPoolStorage storage(isoDataDirectory, true);
+		Array<File> storedDirectories;
+
+		for (const auto &clientNAME : storage.get_clients())
+		{
+			std::ostringstream nameString;
+			nameString << std::hex << std::setfill('0') << std::setw(16) << clientNAME.get_full_name();
+			storedDirectories.add(isoDataDirectory.getChildFile(nameString.str()));
+
+			for (const auto &label : storage.get_versions(clientNAME))
+			{
+				PoolSource pool;
+				pool.name = String(nameString.str()) + " [" + String::fromUTF8(reinterpret_cast<const char *>(label.data()), static_cast<int>(label.size())).trimEnd() + "]";
+				pool.rawData.push_back(storage.load_version(std::vector<std::uint8_t>(label.begin(), label.end()), clientNAME));
+				retVal.push_back(std::move(pool));
+			}
+		}
+
+		Array<File> directories = isoDataDirectory.findChildFiles(File::findDirectories, true);
+		directories.add(isoDataDirectory);
+		directories.sort();
+
+		for (const auto &directory : directories)
+		{
+			if (!storedDirectories.contains(directory))
+			{
+				auto plainFiles = directory.findChildFiles(File::findFiles, false, "*.iop");
+				plainFiles.sort();
+
+				for (const auto &file : plainFiles)
+				{
+					PoolSource pool;
+					pool.name = file.getRelativePathFrom(isoDataDirectory);
+					pool.rawData.push_back(read_file(file));
+					retVal.push_back(std::move(pool));
+				}
+			}
+		}
+		return retVal;
+	}
+
+	std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> parse_pool(PoolSource &pool)
+	{
+		auto retVal = std::make_shared<isobus::VirtualTerminalServerManagedWorkingSet>(nullptr);
+
+		for (auto &data : pool.rawData)
+		{
+			retVal->add_iop_raw_data(data);
+		}
+		retVal->start_parsing_thread();
+
+		while ((isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Success != retVal->get_object_pool_processing_state()) &&
+		       (isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Fail != retVal->get_object_pool_processing_state()))
+		{
+			Thread::sleep(1);
+		}
+
+		bool parsed = (isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Success == retVal->get_object_pool_processing_state());
+		retVal->join_parsing_thread();
+
+		if (!parsed)
+		{
+			retVal.reset();
+		}
+		return retVal;
+	}
+
+	/// @brief Builds and paints a mask from scratch, the way a freshly uploaded pool is shown
+	MaskResult benchmark_mask(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::shared_ptr<isobus::VTObject> mask, int iterations)
+	{
+		MaskResult retVal;
+		retVal.objectID = mask->get_id();
+		retVal.typeName = get_mask_type_name(mask->get_object_type());
+		int completedIterations = 0;
+
+		for (int i = 0; i < iterations; i++)
+		{
+			// Start cold every time, so decoded pictures and cached trees from the last run don't hide any cost
+			JuceManagedWorkingSetCache::remove_working_set(workingSet);
+			PictureGraphicCache::remove_working_set(workingSet);
+
+			auto baselineBytes = allocatedBytes.load();
+			auto baselineCount = allocationCount.load();
+			peakAllocatedBytes = baselineBytes;
+
+			auto buildStart = std::chrono::steady_clock::now();
+			auto component = JuceManagedWorkingSetCache::create_component(workingSet, mask);
+			auto buildEnd = std::chrono::steady_clock::now();
+
+			if ((nullptr == component) || (component->getWidth() <= 0) || (component->getHeight() <= 0))
+			{
+				break;
+			}
+
+			Image image(Image::PixelFormat::ARGB, component->getWidth(), component->getHeight(), true);
+			{
+				Graphics graphics(image);
+				component->paintEntireComponent(graphics, true);
+			}
+			auto paintEnd = std::chrono::steady_clock::now();
+
+			retVal.buildTimeMs += std::chrono::duration<double, std::milli>(buildEnd - buildStart).count();
+			retVal.paintTimeMs += std::chrono::duration<double, std::milli>(paintEnd - buildEnd).count();
+			retVal.allocations = allocationCount.load() - baselineCount;
+			retVal.peakBytes = peakAllocatedBytes.load() - baselineBytes;
+			retVal.built = true;
+			completedIterations++;
+		}
+
+		// A build can fail part way through the run, so only the iterations that finished are averaged
+		if (completedIterations > 0)
+		{
+			retVal.buildTimeMs /= completedIterations;
+			retVal.paintTimeMs /= completedIterations;
+		}
+		return retVal;
+	}
+}
+
+void *operator new(std::size_t size)
+{
+	auto retVal = tracked_allocate(size);
+
+	if (nullptr == retVal)
+	{
+		throw std::bad_alloc();
+	}
+	return retVal;
+}
+
+void *operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+	return tracked_allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+	return tracked_allocate(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+	tracked_free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+	tracked_free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+	tracked_free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+	tracked_free(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept
+{
+	tracked_free(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept
+{
+	tracked_free(pointer);
+}
+
+int main(int argc, char *argv[])
+{
+	ScopedJuceInitialiser_GUI juceInitialiser;
+	File isoDataDirectory = File::getSpecialLocation(File::userApplicationDataDirectory).getChildFile("Open-Agriculture").getChildFile("iso_data");
+	int iterations = DEFAULT_ITERATIONS;
+	int retVal = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		String argument(argv[i]);
+
+		if (argument.startsWith("--iterations="))
+		{
+			iterations = jmax(1, argument.fromFirstOccurrenceOf("=", false, false).getIntValue());
+		}
+		else
+		{
+			isoDataDirectory = File::getCurrentWorkingDirectory().getChildFile(argument);
+		}
+	}
+
+	if (!isoDataDirectory.isDirectory())
+	{
+		std::cerr << "Usage: AgISOVirtualTerminalRenderBenchmark [--iterations=N] [iso_data directory]" << std::endl;
+		std::cerr << "No directory at " << isoDataDirectory.getFullPathName() << std::endl;
+		return 1;
+	}
+
+	auto pools = find_pools(isoDataDirectory);
+	std::cout << "Rendering " << pools.size() << " pool(s) from " << isoDataDirectory.getFullPathName() << ", average of " << iterations << " runs per mask" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	for (auto &pool : pools)
+	{
+		auto workingSet = parse_pool(pool);
+		std::cout << std::endl
+		          << pool.name << std::endl;
+
+		if (nullptr == workingSet)
+		{
+			std::cout << "  failed to parse" << std::endl;
+			retVal = 1;
+			continue;
+		}
+
+		std::cout << "  " << std::left << std::setw(12) << "mask" << std::setw(8) << "id" << std::right
+		          << std::setw(12) << "build ms" << std::setw(12) << "paint ms" << std::setw(14) << "allocations" << std::setw(14) << "peak KiB" << std::endl;
+
+		for (const auto &object : workingSet->get_object_tree())
+		{
+			auto typeName = get_mask_type_name(object.second->get_object_type());
+
+			if (typeName.isNotEmpty())
+			{
+				auto result = benchmark_mask(workingSet, object.second, iterations);
+
+				std::cout << "  " << std::left << std::setw(12) << result.typeName << std::setw(8) << result.objectID << std::right;
+
+				if (result.built)
+				{
+					std::cout << std::setw(12) << result.buildTimeMs << std::setw(12) << result.paintTimeMs << std::setw(14) << result.allocations << std::setw(14) << (result.peakBytes / 1024.0) << std::endl;
+				}
+				else
+				{
+					std::cout << "  failed to build" << std::endl;
+					retVal = 1;
+				}
+			}
+		}
+		JuceManagedWorkingSetCache::remove_working_set(workingSet);
+		PictureGraphicCache::remove_working_set(workingSet);
+	}
+	return retVal;
+}
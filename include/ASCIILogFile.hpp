@@ -11,23 +11,76 @@
 
 #include "isobus/hardware_integration/can_hardware_interface.hpp"
 
+#include "CANTraceFile.hpp"
 #include "JuceHeader.h"
 
-/// @brief Logs to Vector .asc file
-class ASCIILogFile
+#include <atomic>
+#include <vector>
+
+/// @brief Logs to Vector .asc file, or to a compact binary .cantrace file if the settings select it
+/// @details The CAN frame callbacks only copy each frame into a lock free ring buffer.
+/// A background thread formats the frames and writes them to a file stream that stays open
+/// for the lifetime of the logger, so the CAN threads never wait on the file system.
+/// The thread sleeps while the bus is quiet, and the file is only synced to the disk every
+/// SYNC_INTERVAL_MS and when the log is closed, to spare the flash storage of in-cab displays.
+class ASCIILogFile : private Thread
 {
 public:
 	ASCIILogFile();
 
-	~ASCIILogFile() = default;
+	~ASCIILogFile() override;
 
 	std::string currentLogFile() const;
 
 private:
+	using FrameRecord = CANTraceFile::Record;
+
+	/// @brief A single producer, single consumer queue of frames for one of the frame callbacks
+	class FrameQueue
+	{
+	public:
+		explicit FrameQueue(int capacity);
+
+		/// @brief Adds a frame to the queue, called only from the thread the frame callback runs on
+		/// @returns False if the queue was full and the frame was dropped
+		bool push(const FrameRecord &frame);
+
+		/// @brief Moves every queued frame to the end of a vector, called only from the writer thread
+		void pop_all(std::vector<FrameRecord> &destination);
+
+		/// @brief Returns if there are no queued frames
+		bool is_empty() const;
+
+	private:
+		AbstractFifo fifo;
+		std::vector<FrameRecord> buffer;
+	};
+
+	void run() override;
+	void on_frame(const isobus::CANMessageFrame &canFrame, bool transmitted);
+	void write_queued_frames();
+	void sync_if_due();
+	int get_time_until_sync_ms() const;
+
+	static constexpr int QUEUE_CAPACITY = 8192; ///< Frames per direction, which is over a second of a fully loaded 500k bus
+	static constexpr int WRITE_INTERVAL_MS = 50; ///< How long the writer thread collects frames before writing them
+	static constexpr std::uint32_t SYNC_INTERVAL_MS = 5000; ///< The longest written frames go without being synced to the disk
+
 	File logFile;
+	std::unique_ptr<FileOutputStream> logStream;
+	FrameQueue receivedFrames;
+	FrameQueue transmittedFrames;
+	std::vector<FrameRecord> pendingFrames; ///< Frames popped from the queues, only used by the writer thread
+	std::string formattedFrames; ///< Text or binary records for the frames being written, only used by the writer thread
+	std::atomic<std::uint32_t> droppedFrameCount = { 0 };
+	std::atomic_bool writerWaitingForFrames = { false }; ///< True while the writer thread may sleep until a frame is queued
+	std::uint32_t lastSyncTime = 0; ///< Millisecond counter when the file was last synced, only used by the writer thread
+	bool unsyncedFrames = false; ///< True if frames were written since the last sync, only used by the writer thread
 	isobus::EventCallbackHandle canFrameReceivedListener;
 	isobus::EventCallbackHandle canFrameSentListener;
 	Time initialTimestamp;
+	std::int64_t initialTicks = 0; ///< High resolution tick count when the log was started
+	bool binaryFormat = false; ///< Whether frames are written as .cantrace records instead of .asc text
 };
 
 #endif // ASCII_LOG_FILE_HPP
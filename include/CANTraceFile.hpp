@@ -0,0 +1,79 @@
+//================================================================================================
+/// @file CANTraceFile.hpp
+///
+/// @brief Defines a compact binary CAN trace format, and conversion of traces to Vector .asc text.
+/// @author The Open-Agriculture Developers
+///
+/// @copyright 2025 The Open-Agriculture Developers
+//================================================================================================
+#ifndef CAN_TRACE_FILE_HPP
+#define CAN_TRACE_FILE_HPP
+
+#include "JuceHeader.h"
+
+#include <string>
+
+/// @brief Reads and writes .cantrace files, which store CAN frames as fixed size little endian records.
+/// @details A trace starts with a HEADER_SIZE byte header:
+/// - 8 bytes: the magic "AGVTCANT"
+/// - 2 bytes: the format version
+/// - 2 bytes: the size of each record
+/// - 4 bytes: reserved
+/// - 8 bytes: the time the trace was started, in milliseconds since the Unix epoch
+///
+/// It is followed by records of RECORD_SIZE bytes, which are only ever appended:
+/// - 8 bytes: the time since the trace was started, in microseconds
+/// - 4 bytes: the CAN identifier
+/// - 1 byte: the data length
+/// - 1 byte: flags, bit 0 is set for transmitted frames
+/// - 2 bytes: reserved
+/// - 8 bytes: the data, zero padded
+///
+/// Because every record is the same size, a trace can be memory mapped and read at any record
+/// boundary, even while it is still being written.
+class CANTraceFile
+{
+public:
+	/// @brief One CAN frame in a trace
+	struct Record
+	{
+		std::uint64_t timestampUs; ///< Time since the trace was started
+		std::uint32_t identifier;
+		std::uint8_t data[8];
+		std::uint8_t dataLength;
+		bool transmitted;
+	};
+
+	/// @brief Appends a binary trace header
+	/// @param[in,out] destination The buffer to append to
+	/// @param[in] startTime The time the trace was started
+	static void append_header(std::string &destination, Time startTime);
+
+	/// @brief Appends one frame as a binary trace record
+	/// @param[in,out] destination The buffer to append to
+	/// @param[in] record The frame to append
+	static void append_record(std::string &destination, const Record &record);
+
+	/// @brief Appends the header lines of a Vector .asc file
+	/// @param[in,out] destination The buffer to append to
+	/// @param[in] startTime The time the log was started
+	static void append_asc_header(std::string &destination, Time startTime);
+
+	/// @brief Appends one frame as a line of a Vector .asc file
+	/// @param[in,out] destination The buffer to append to
+	/// @param[in] record The frame to append
+	static void append_asc_line(std::string &destination, const Record &record);
+
+	/// @brief Converts a binary trace to a Vector .asc file
+	/// @param[in] traceFile The .cantrace file to read
+	/// @param[in,out] destination The stream to write the .asc text to
+	/// @returns True if the file was a valid trace and was converted, otherwise false
+	static bool export_to_asc(const File &traceFile, OutputStream &destination);
+
+	static constexpr std::size_t HEADER_SIZE = 24; ///< The size of the file header, in bytes
+	static constexpr std::size_t RECORD_SIZE = 24; ///< The size of each record, in bytes
+	static constexpr std::uint16_t FORMAT_VERSION = 1; ///< The current version of the format
+	static constexpr const char *FILE_EXTENSION = ".cantrace"; ///< The extension used for trace files
+};
+
+#endif // CAN_TRACE_FILE_HPP
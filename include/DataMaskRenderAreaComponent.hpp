@@ -12,6 +12,7 @@
 #include "isobus/isobus/isobus_virtual_terminal_objects.hpp"
 #include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
 
+#include "HitTestEngine.hpp"
 #include "JuceHeader.h"
 
 class ServerMainComponent;
@@ -25,6 +26,9 @@ public:
 
 	void on_working_set_disconnect(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
 
+	// Rebuilds the hit test index on the next query if the changed objects could have moved an interactive object
+	void on_objects_changed(const std::set<std::uint16_t> &objectIDs);
+
 	void paint(Graphics &g) override;
 
 	// Used to calculate button press events
@@ -33,6 +37,9 @@ public:
 	// Used to calculate button release events
 	void mouseUp(const MouseEvent &event) override;
 
+	// Moves the input focus through the interactive objects with tab and shift+tab
+	bool keyPressed(const KeyPress &key) override;
+
 	bool needsRepaint() const;
 
 	void set_has_started(bool started);
@@ -55,10 +62,6 @@ private:
 		std::uint32_t lastValue = 0;
 	};
 
-	std::shared_ptr<isobus::VTObject> getClickedChildRecursive(std::shared_ptr<isobus::VTObject> object, int x, int y);
-	static bool objectCanBeClicked(std::shared_ptr<isobus::VTObject> object);
-	static bool isClickWithinBounds(int clickXRelative, int clickYRelative, int objectX, int objectY, int objectWidth, int objectHeight);
-
 	std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> parentWorkingSet;
 	std::unique_ptr<AlertWindow> inputListModal;
 	std::unique_ptr<AlertWindow> inputNumberModal;
@@ -68,6 +71,7 @@ private:
 	std::vector<std::shared_ptr<Component>> currentModalComponentCache;
 	ServerMainComponent &ownerServer;
 	InputNumberListener inputNumberListener;
+	HitTestEngine hitTestEngine{ HitTestEngine::Layout::DataMask }; ///< Finds the interactive objects of the active mask
 	bool needToRepaintActiveArea = false;
 	bool hasStarted = false;
 
@@ -0,0 +1,80 @@
+//================================================================================================
+/// @file ECUToVTCommands.hpp
+///
+/// @brief Defines the function codes of ECU to VT commands and how they affect what is drawn.
+/// @author The Open-Agriculture Developers
+///
+/// @copyright 2025 The Open-Agriculture Developers
+//================================================================================================
+#ifndef ECU_TO_VT_COMMANDS_HPP
+#define ECU_TO_VT_COMMANDS_HPP
+
+#include <cstdint>
+
+/// @brief The ECU to VT command function codes the GUI cares about, and which of them can change
+/// what is drawn, shared by everything that watches the commands a client sends.
+class ECUToVTCommands
+{
+public:
+	static constexpr std::uint8_t FIRST_OBJECT_COMMAND = 0xA0;
+	static constexpr std::uint8_t LAST_OBJECT_COMMAND = 0xBF;
+	static constexpr std::uint8_t HIDE_SHOW_OBJECT_COMMAND = 0xA0;
+	static constexpr std::uint8_t ENABLE_DISABLE_OBJECT_COMMAND = 0xA1;
+	static constexpr std::uint8_t SELECT_INPUT_OBJECT_COMMAND = 0xA2;
+	static constexpr std::uint8_t CONTROL_AUDIO_SIGNAL_COMMAND = 0xA3;
+	static constexpr std::uint8_t SET_AUDIO_VOLUME_COMMAND = 0xA4;
+	static constexpr std::uint8_t CHANGE_CHILD_LOCATION_COMMAND = 0xA5;
+	static constexpr std::uint8_t CHANGE_SIZE_COMMAND = 0xA6;
+	static constexpr std::uint8_t CHANGE_BACKGROUND_COLOUR_COMMAND = 0xA7;
+	static constexpr std::uint8_t CHANGE_NUMERIC_VALUE_COMMAND = 0xA8;
+	static constexpr std::uint8_t CHANGE_END_POINT_COMMAND = 0xA9;
+	static constexpr std::uint8_t CHANGE_FONT_ATTRIBUTES_COMMAND = 0xAA;
+	static constexpr std::uint8_t CHANGE_LINE_ATTRIBUTES_COMMAND = 0xAB;
+	static constexpr std::uint8_t CHANGE_FILL_ATTRIBUTES_COMMAND = 0xAC;
+	static constexpr std::uint8_t CHANGE_ACTIVE_MASK_COMMAND = 0xAD;
+	static constexpr std::uint8_t CHANGE_SOFT_KEY_MASK_COMMAND = 0xAE;
+	static constexpr std::uint8_t CHANGE_ATTRIBUTE_COMMAND = 0xAF;
+	static constexpr std::uint8_t CHANGE_PRIORITY_COMMAND = 0xB0;
+	static constexpr std::uint8_t CHANGE_LIST_ITEM_COMMAND = 0xB1;
+	static constexpr std::uint8_t DELETE_OBJECT_POOL_COMMAND = 0xB2;
+	static constexpr std::uint8_t CHANGE_STRING_VALUE_COMMAND = 0xB3;
+	static constexpr std::uint8_t CHANGE_CHILD_POSITION_COMMAND = 0xB4;
+	static constexpr std::uint8_t CHANGE_OBJECT_LABEL_COMMAND = 0xB5;
+	static constexpr std::uint8_t CHANGE_POLYGON_POINT_COMMAND = 0xB6;
+	static constexpr std::uint8_t CHANGE_POLYGON_SCALE_COMMAND = 0xB7;
+	static constexpr std::uint8_t GRAPHICS_CONTEXT_COMMAND = 0xB8;
+	static constexpr std::uint8_t GET_ATTRIBUTE_VALUE_MESSAGE = 0xB9;
+	static constexpr std::uint8_t SELECT_COLOUR_MAP_OR_PALETTE_COMMAND = 0xBA;
+	static constexpr std::uint8_t IDENTIFY_VT_MESSAGE = 0xBB;
+
+	/// @brief Returns if a command can change what is drawn.
+	/// @details Anything outside of the object manipulation commands (status, technical data, pool
+	/// transfer, auxiliary control) can't, and neither can the queries, the audio commands, or
+	/// deleting the pool, which replaces the whole working set anyway.
+	/// @param[in] functionCode The command's function code
+	/// @returns True if the command can change what is drawn
+	static constexpr bool can_change_drawing(std::uint8_t functionCode)
+	{
+		return (functionCode >= FIRST_OBJECT_COMMAND) &&
+		  (functionCode <= LAST_OBJECT_COMMAND) &&
+		  (CONTROL_AUDIO_SIGNAL_COMMAND != functionCode) &&
+		  (SET_AUDIO_VOLUME_COMMAND != functionCode) &&
+		  (DELETE_OBJECT_POOL_COMMAND != functionCode) &&
+		  (GET_ATTRIBUTE_VALUE_MESSAGE != functionCode) &&
+		  (IDENTIFY_VT_MESSAGE != functionCode);
+	}
+
+	/// @brief Returns if a command changes the objects of the working set, so the masks have to be updated.
+	/// @details Select Input Object and Change Active Mask change what is drawn too, but the server
+	/// applies them through its own callbacks rather than by updating the masks' objects.
+	/// @param[in] functionCode The command's function code
+	/// @returns True if the command can change the objects that are drawn
+	static constexpr bool changes_objects(std::uint8_t functionCode)
+	{
+		return can_change_drawing(functionCode) &&
+		  (SELECT_INPUT_OBJECT_COMMAND != functionCode) &&
+		  (CHANGE_ACTIVE_MASK_COMMAND != functionCode);
+	}
+};
+
+#endif // ECU_TO_VT_COMMANDS_HPP
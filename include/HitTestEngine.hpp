@@ -0,0 +1,95 @@
+//================================================================================================
+/// @file HitTestEngine.hpp
+///
+/// @brief Defines the hit testing and navigation order shared by the mask render areas.
+/// @author The Open-Agriculture Developers
+///
+/// @copyright 2025 The Open-Agriculture Developers
+//================================================================================================
+#ifndef HIT_TEST_ENGINE_HPP
+#define HIT_TEST_ENGINE_HPP
+
+#include "isobus/isobus/isobus_virtual_terminal_objects.hpp"
+#include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
+
+#include "HitTestIndex.hpp"
+
+#include <memory>
+#include <set>
+#include <vector>
+
+/// @brief Finds the interactive objects of the mask a render area shows.
+/// @details The first query after the mask changes walks the mask once, following object pointers
+/// and skipping hidden containers, and stores the absolute bounds of every interactive object in a
+/// HitTestIndex. Later presses and releases are answered from that index, and the order the objects
+/// were found in is also the order keyboard navigation moves through them.
+class HitTestEngine
+{
+public:
+	/// @brief How a render area lays out and interacts with its mask
+	enum class Layout
+	{
+		DataMask, ///< Children are where the mask places them, and input objects, buttons and keys are interactive
+		SoftKeyMask ///< Children are placed in the soft key grid, and only keys are interactive
+	};
+
+	/// @brief Constructor
+	/// @param[in] layout How the render area lays out its mask
+	explicit HitTestEngine(Layout layout);
+
+	/// @brief Sets the working set whose active mask is shown, which invalidates the index
+	/// @param[in] workingSet The working set, or nullptr if none is shown
+	void set_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
+	/// @brief Sets the geometry of the soft key grid, which is only used by the SoftKeyMask layout
+	/// @param[in] keyWidth The width of each soft key
+	/// @param[in] keyHeight The height of each soft key
+	/// @param[in] columns The number of soft key columns
+	/// @param[in] rows The number of soft key rows
+	void set_soft_key_layout(int keyWidth, int keyHeight, int columns, int rows);
+
+	/// @brief Rebuilds the index on the next query if the changed objects could have moved or
+	/// hidden an interactive object
+	/// @param[in] objectIDs The IDs of the changed objects
+	void on_objects_changed(const std::set<std::uint16_t> &objectIDs);
+
+	/// @brief Returns the mask that the render area shows for the current working set
+	/// @returns The active mask for the DataMask layout, the soft key mask of the active mask for the
+	/// SoftKeyMask layout, or nullptr if there is none
+	std::shared_ptr<isobus::VTObject> get_displayed_mask() const;
+
+	/// @brief Finds the interactive object at a point of the displayed mask
+	/// @param[in] x The x position relative to the render area
+	/// @param[in] y The y position relative to the render area
+	/// @returns The object, or nullptr if there is no interactive object at that point
+	std::shared_ptr<isobus::VTObject> find(int x, int y);
+
+	/// @brief Returns the interactive objects of the displayed mask, in navigation order
+	/// @returns The object IDs, each listed once
+	const std::vector<std::uint16_t> &get_navigation_order();
+
+	/// @brief Returns the object that keyboard navigation moves to from another object
+	/// @param[in] currentObjectID The object that currently has focus, or NULL_OBJECT_ID for none
+	/// @param[in] forward True to move to the next object, false to move to the previous one
+	/// @returns The object to move to, wrapping around at either end, or NULL_OBJECT_ID if there is none
+	std::uint16_t get_next_in_navigation_order(std::uint16_t currentObjectID, bool forward);
+
+private:
+	void update_index();
+	void add_children(std::shared_ptr<isobus::VTObject> object, int x, int y);
+	void add_child(std::shared_ptr<isobus::VTObject> child, int x, int y);
+	bool is_interactive(std::shared_ptr<isobus::VTObject> object) const;
+
+	const Layout layout;
+	std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet;
+	HitTestIndex index; ///< The interactive objects of indexedMaskID
+	std::vector<std::uint16_t> navigationOrder; ///< The interactive objects of indexedMaskID, in the order they were found
+	std::uint16_t indexedMaskID = isobus::NULL_OBJECT_ID;
+	int softKeyWidth = 0;
+	int softKeyHeight = 0;
+	int softKeyColumns = 1;
+	int softKeyRows = 1;
+	bool indexValid = false;
+};
+
+#endif // HIT_TEST_ENGINE_HPP
@@ -0,0 +1,82 @@
+//================================================================================================
+/// @file HitTestIndex.hpp
+///
+/// @brief Defines a spatial index of the clickable objects in a mask.
+/// @author The Open-Agriculture Developers
+///
+/// @copyright 2025 The Open-Agriculture Developers
+//================================================================================================
+#ifndef HIT_TEST_INDEX_HPP
+#define HIT_TEST_INDEX_HPP
+
+#include "isobus/isobus/isobus_virtual_terminal_objects.hpp"
+
+#include <memory>
+#include <set>
+#include <vector>
+
+/// @brief A flat list of the clickable objects in a mask, with their absolute bounds, and a
+/// uniform grid over those bounds so that a click only has to be tested against the few objects
+/// whose bounds overlap the grid cell it lands in.
+/// @details Objects are added in the order the object tree is searched, and when bounds overlap
+/// the object that was added first is the one that is found, the same as a top down search
+/// of the tree would find. The index also remembers which objects it was built from, so that
+/// it can tell if a change to an object could have moved or hidden something in it.
+class HitTestIndex
+{
+public:
+	/// @brief Removes every object from the index
+	void clear();
+
+	/// @brief Adds a clickable object to the index. Call finalise once every object has been added.
+	/// @param[in] object The clickable object
+	/// @param[in] x The object's x position relative to the mask
+	/// @param[in] y The object's y position relative to the mask
+	/// @param[in] width The object's width
+	/// @param[in] height The object's height
+	void add(std::shared_ptr<isobus::VTObject> object, int x, int y, int width, int height);
+
+	/// @brief Records that the position or visibility of the indexed objects depends on an object
+	/// @param[in] objectID The ID of the object, such as a mask, container or object pointer
+	void add_dependency(std::uint16_t objectID);
+
+	/// @brief Builds the grid over the objects that were added
+	void finalise();
+
+	/// @brief Finds the object at a point
+	/// @param[in] x The x position relative to the mask
+	/// @param[in] y The y position relative to the mask
+	/// @returns The first object added whose bounds contain the point, or nullptr if there is none
+	std::shared_ptr<isobus::VTObject> find(int x, int y) const;
+
+	/// @brief Returns if any of a set of objects was used to build the index
+	/// @param[in] objectIDs The IDs of the objects to check
+	/// @returns True if the index may be out of date after those objects changed
+	bool depends_on_any(const std::set<std::uint16_t> &objectIDs) const;
+
+private:
+	/// @brief One clickable object, with bounds that include their right and bottom edges
+	struct Entry
+	{
+		std::shared_ptr<isobus::VTObject> object;
+		int left;
+		int top;
+		int right;
+		int bottom;
+	};
+
+	static constexpr int MINIMUM_CELL_SIZE = 32; ///< The smallest grid cell, in pixels
+	static constexpr int MAXIMUM_CELLS_PER_SIDE = 64; ///< Cells get bigger rather than exceed this many per row or column
+
+	std::vector<Entry> entries; ///< Every clickable object, in search order
+	std::vector<std::uint32_t> cellStarts; ///< For each cell, where its entries start in cellEntries, plus one past the end
+	std::vector<std::uint32_t> cellEntries; ///< The indices of the entries that overlap each cell, in search order
+	std::set<std::uint16_t> dependencies; ///< The objects the index was built from
+	int gridLeft = 0;
+	int gridTop = 0;
+	int cellSize = MINIMUM_CELL_SIZE;
+	int columns = 0;
+	int rows = 0;
+};
+
+#endif // HIT_TEST_INDEX_HPP
@@ -13,11 +13,47 @@
 #include "JuceHeader.h"
 #include "SoftKeyMaskComponent.hpp"
 
+#include <set>
+
 class JuceManagedWorkingSetCache
 {
 public:
 	static std::shared_ptr<Component> create_component(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::shared_ptr<isobus::VTObject> sourceObject);
 
+	/// @brief Returns the component tree for a data mask, alarm mask, or soft key mask.
+	/// The tree is only built the first time a mask is requested, and is then kept until the
+	/// working set's cache is invalidated, so that switching back and forth between masks is cheap.
+	/// @param[in] workingSet The working set that owns the mask
+	/// @param[in] maskObject The mask to get a component for
+	/// @returns The component for the mask, or nullptr if one could not be created
+	static std::shared_ptr<Component> get_mask_component(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::shared_ptr<isobus::VTObject> maskObject);
+
+	/// @brief Discards all cached mask components for a working set.
+	/// Call this whenever the contents of the working set's object pool changed in a way that
+	/// requires the masks to be rebuilt.
+	/// @param[in] workingSet The working set whose masks should be discarded
+	static void invalidate(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
+	/// @brief Discards the cached trees of a working set's active mask and its soft key mask, along
+	/// with any other cached mask that draws one of the changed objects, and keeps the rest.
+	/// Use the overload without object IDs instead if the change can't be attributed to objects,
+	/// such as when a macro ran.
+	/// @param[in] workingSet The working set whose masks should be discarded
+	/// @param[in] objectIDs The IDs of the objects that changed
+	static void invalidate(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, const std::set<std::uint16_t> &objectIDs);
+
+	/// @brief Brings the components that draw some objects up to date with the working set's
+	/// object pool, and repaints only those components.
+	/// @param[in] workingSet The working set that owns the objects
+	/// @param[in] objectIDs The IDs of the objects that changed
+	/// @returns True if every change was applied, or false if at least one of the objects can't be
+	/// updated in place and the masks need to be rebuilt instead (in which case nothing was changed)
+	static bool update_components(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, const std::set<std::uint16_t> &objectIDs);
+
+	/// @brief Removes everything associated with a working set from the cache, such as when it disconnects
+	/// @param[in] workingSet The working set to remove
+	static void remove_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
 	static void set_softkey_mask_dimension_info(const SoftKeyMaskDimensions &info);
 
 private:
@@ -28,8 +64,18 @@ private:
 		  workingSet(associatedWorkingSet){};
 
 		std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet;
-		//std::map<std::uint16_t, std::shared_ptr<Component>> componentLookup;
+		std::map<std::uint16_t, std::shared_ptr<Component>> maskComponentLookup; ///< Built masks, by mask object ID
+		std::map<std::uint16_t, std::vector<Component::SafePointer<Component>>> componentLookup; ///< Every live component, by the ID of the object it draws
+		std::map<std::uint16_t, std::vector<Component::SafePointer<Component>>> dependentComponentLookup; ///< Every live component, by the IDs of the variables and attributes it reads when painting
 	};
+
+	static void register_component(std::vector<Component::SafePointer<Component>> &registeredComponents, Component *component);
+	static void register_dependencies(ComponentCacheClass &cache, std::shared_ptr<isobus::VTObject> sourceObject, Component *component);
+	static bool can_update_in_place(std::shared_ptr<isobus::VTObject> object);
+	static void refresh_component(Component &component, std::shared_ptr<isobus::VTObject> liveObject);
+
+	static ComponentCacheClass &get_cache_for_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
 	static std::vector<ComponentCacheClass> workingSetComponentCache;
 
 	static SoftKeyMaskDimensions softKeyDimensionInfo;
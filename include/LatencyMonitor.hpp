@@ -0,0 +1,125 @@
+//================================================================================================
+/// @file LatencyMonitor.hpp
+///
+/// @brief Defines a class that measures how long ECU to VT commands take to reach the screen.
+/// @author The Open-Agriculture Developers
+///
+/// @copyright 2025 The Open-Agriculture Developers
+//================================================================================================
+#ifndef LATENCY_MONITOR_HPP
+#define LATENCY_MONITOR_HPP
+
+#include "isobus/isobus/can_internal_control_function.hpp"
+#include "isobus/isobus/can_message.hpp"
+
+#include "JuceHeader.h"
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// @brief Timestamps each ECU to VT command that can change what is drawn when it is received,
+/// when the GUI notices the change, and when the next paint of the masks finishes, and keeps
+/// the most recent latencies of each command type so that their percentiles can be shown.
+/// @details Commands that are not noticed or painted within STALE_COMMAND_TIMEOUT_MS, such as
+/// those sent to a working set that isn't shown or while the window isn't painted, are discarded
+/// rather than recorded.
+/// A paint of either mask completes every noticed command, since which objects a paint redrew isn't
+/// known. A command that changes nothing visible is therefore completed by the next unrelated paint,
+/// such as the latency overlay's own refresh once a second, which biases the painted latencies upwards.
+class LatencyMonitor
+{
+public:
+	/// @brief The 50th, 95th and 99th percentiles of a set of latencies, in milliseconds
+	struct Percentiles
+	{
+		double p50 = 0.0;
+		double p95 = 0.0;
+		double p99 = 0.0;
+	};
+
+	/// @brief The latencies recorded for one command type
+	struct CommandStatistics
+	{
+		std::uint8_t functionCode = 0; ///< The command's function code
+		std::size_t sampleCount = 0; ///< The number of commands the percentiles are calculated from
+		Percentiles noticed; ///< From receipt until the GUI noticed the change
+		Percentiles painted; ///< From receipt until the masks were painted
+	};
+
+	LatencyMonitor() = default;
+	~LatencyMonitor();
+
+	/// @brief Starts timestamping ECU to VT commands. Call this before the VT server is initialized
+	/// so that each command is timestamped before the server processes it.
+	/// @param[in] serverControlFunction The VT server's control function
+	void initialize(std::shared_ptr<isobus::InternalControlFunction> serverControlFunction);
+
+	/// @brief Stops timestamping ECU to VT commands
+	void terminate();
+
+	/// @brief Records that the GUI has picked up every command received so far from a client, and
+	/// discards noticed commands that have waited too long for a paint
+	/// @param[in] client The client whose commands were noticed
+	void on_changes_noticed(std::shared_ptr<isobus::ControlFunction> client);
+
+	/// @brief Records that a paint of the masks finished, which completes every noticed command
+	void on_paint_finished();
+
+	/// @brief Returns the percentiles of each command type that has been recorded
+	/// @returns The statistics, sorted by function code
+	std::vector<CommandStatistics> get_statistics() const;
+
+	/// @brief Writes the statistics of each command type to a CSV file
+	/// @param[in] file The file to write, which is replaced if it exists
+	/// @returns True if the file was written
+	bool write_csv(const File &file) const;
+
+	/// @brief Returns a readable name for an ECU to VT command
+	/// @param[in] functionCode The command's function code
+	/// @returns The name of the command
+	static String get_command_name(std::uint8_t functionCode);
+
+private:
+	/// @brief A command that has been received but not yet painted
+	struct PendingCommand
+	{
+		double receivedTime_ms; ///< When the command was received
+		double noticedTime_ms; ///< When the GUI noticed the command, if it has
+		std::uint8_t functionCode; ///< The command's function code
+	};
+
+	/// @brief The most recent latencies of one command type, as a ring buffer
+	struct Samples
+	{
+		std::vector<double> noticed_ms; ///< From receipt until the GUI noticed the change
+		std::vector<double> painted_ms; ///< From receipt until the masks were painted
+		std::size_t nextSample = 0; ///< Where the next sample is written once the buffer is full
+	};
+
+	static constexpr std::size_t MAXIMUM_SAMPLES_PER_COMMAND = 1000; ///< Older latencies are replaced after this many
+	static constexpr std::size_t MAXIMUM_PENDING_COMMANDS = 256; ///< The most commands that are waiting for each client
+	static constexpr std::size_t MAXIMUM_NOTICED_COMMANDS = 1024; ///< The most commands that are waiting for a paint
+	static constexpr double STALE_COMMAND_TIMEOUT_MS = 5000.0; ///< Commands waiting longer than this are discarded
+
+	/// @brief Processes an ECU to VT message from the network manager
+	/// @param[in] message The received message
+	/// @param[in] parentPointer A pointer to the monitor instance
+	static void process_rx_message(const isobus::CANMessage &message, void *parentPointer);
+
+	/// @brief Calculates the percentiles of a set of latencies
+	/// @param[in] values The latencies, which are sorted in place
+	/// @returns The percentiles, or zeros if there are no values
+	static Percentiles get_percentiles(std::vector<double> &values);
+
+	std::map<std::shared_ptr<isobus::ControlFunction>, std::deque<PendingCommand>> receivedCommands; ///< Commands not yet noticed, by client
+	std::vector<PendingCommand> noticedCommands; ///< Commands that were noticed but not yet painted
+	std::map<std::uint8_t, Samples> samples; ///< The recorded latencies, by function code
+	std::shared_ptr<isobus::InternalControlFunction> serverInternalControlFunction; ///< The VT server's control function
+	mutable std::mutex monitorMutex; ///< Protects everything above, since commands are received on the CAN stack's thread
+	bool initialized = false;
+};
+
+#endif // LATENCY_MONITOR_HPP
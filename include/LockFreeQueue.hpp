@@ -0,0 +1,111 @@
+//================================================================================================
+/// @file LockFreeQueue.hpp
+///
+/// @brief Defines a lock-free queue for handing work from other threads to the message thread.
+/// @author The Open-Agriculture Developers
+///
+/// @copyright 2025 The Open-Agriculture Developers
+//================================================================================================
+#ifndef LOCK_FREE_QUEUE_HPP
+#define LOCK_FREE_QUEUE_HPP
+
+#include <atomic>
+#include <utility>
+
+/// @brief An unbounded multiple producer, single consumer queue.
+/// @details Any number of threads can push without ever waiting on each other or on the consumer,
+/// since a push is one allocation and one atomic exchange. Only one thread, normally the message
+/// thread, may pop. An item whose push is still in progress on another thread stays invisible
+/// until that push completes, so a pop can return false while such an item is in flight; the
+/// producer should wake the consumer after each push, such as with an AsyncUpdater.
+/// @tparam T The item type, which must be default constructible and movable
+template<typename T>
+class LockFreeQueue
+{
+public:
+	LockFreeQueue() = default;
+
+	~LockFreeQueue()
+	{
+		T discarded;
+
+		while (pop(discarded))
+		{
+		}
+	}
+
+	/// @brief Adds an item to the back of the queue. Can be called from any thread.
+	/// @param[in] value The item to add
+	void push(T &&value)
+	{
+		push_node(new Node(std::move(value)));
+	}
+
+	/// @brief Removes the item at the front of the queue. Must only be called from the consumer thread.
+	/// @param[out] value The item that was removed
+	/// @returns True if an item was removed, false if the queue is empty
+	bool pop(T &value)
+	{
+		bool retVal = false;
+		Node *front = tail;
+		Node *next = front->next.load(std::memory_order_acquire);
+
+		if (&stub == front)
+		{
+			// The stub is skipped over, since it only keeps the list from ever being empty
+			front = next;
+
+			if (nullptr != front)
+			{
+				tail = front;
+				next = front->next.load(std::memory_order_acquire);
+			}
+		}
+
+		if ((nullptr != front) && (nullptr == next) && (front == head.load(std::memory_order_acquire)))
+		{
+			// The last item can only be removed once something else follows it, so put the stub back behind it
+			push_node(&stub);
+			next = front->next.load(std::memory_order_acquire);
+		}
+
+		if ((nullptr != front) && (nullptr != next))
+		{
+			tail = next;
+			value = std::move(front->value);
+			delete front;
+			retVal = true;
+		}
+		return retVal;
+	}
+
+private:
+	/// @brief One item in the queue, linked to the item pushed after it
+	struct Node
+	{
+		Node() = default;
+		explicit Node(T &&nodeValue) :
+		  value(std::move(nodeValue))
+		{
+		}
+
+		std::atomic<Node *> next = { nullptr }; ///< The node pushed after this one, once its push completes
+		T value; ///< The queued item
+	};
+
+	void push_node(Node *node)
+	{
+		node->next.store(nullptr, std::memory_order_relaxed);
+		Node *previous = head.exchange(node, std::memory_order_acq_rel);
+		previous->next.store(node, std::memory_order_release);
+	}
+
+	Node stub; ///< A placeholder node that lets the last item be removed without racing a producer
+	std::atomic<Node *> head = { &stub }; ///< The most recently pushed node, which producers link after
+	Node *tail = &stub; ///< The oldest node, only used by the consumer
+
+	LockFreeQueue(const LockFreeQueue &) = delete;
+	LockFreeQueue &operator=(const LockFreeQueue &) = delete;
+};
+
+#endif // LOCK_FREE_QUEUE_HPP
@@ -0,0 +1,125 @@
+//================================================================================================
+/// @file LockFreeRingBuffer.hpp
+///
+/// @brief Defines a fixed capacity lock-free queue for handing records to a consumer thread.
+/// @author The Open-Agriculture Developers
+///
+/// @copyright 2025 The Open-Agriculture Developers
+//================================================================================================
+#ifndef LOCK_FREE_RING_BUFFER_HPP
+#define LOCK_FREE_RING_BUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/// @brief A bounded multiple producer, single consumer queue that never allocates after construction.
+/// @details Each slot carries a sequence number that says whether it is free for the producer
+/// that claimed it or holds an item ready for the consumer, so pushing is one compare and swap
+/// plus a move, and a full buffer makes push fail instead of waiting for the consumer.
+/// Only one thread may pop.
+/// @tparam T The item type, which must be default constructible and movable
+template<typename T>
+class LockFreeRingBuffer
+{
+public:
+	/// @brief Constructor
+	/// @param[in] minimumCapacity The number of items the buffer must hold, which is rounded up to a power of two
+	explicit LockFreeRingBuffer(std::size_t minimumCapacity)
+	{
+		while (capacity < minimumCapacity)
+		{
+			capacity *= 2;
+		}
+		slots.reset(new Slot[capacity]);
+
+		for (std::size_t i = 0; i < capacity; i++)
+		{
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	/// @brief Adds an item to the back of the buffer. Can be called from any thread.
+	/// @param[in] value The item to add
+	/// @returns True if the item was added, false if the buffer is full
+	bool push(T &&value)
+	{
+		bool retVal = false;
+		std::size_t position = pushPosition.load(std::memory_order_relaxed);
+
+		while (true)
+		{
+			auto &slot = slots[position & (capacity - 1)];
+			const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+			const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+			if (0 == difference)
+			{
+				// The slot is free, so claim it unless another producer got there first
+				if (pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					slot.value = std::move(value);
+					slot.sequence.store(position + 1, std::memory_order_release);
+					retVal = true;
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				// The consumer hasn't emptied this slot since the last lap, so the buffer is full
+				break;
+			}
+			else
+			{
+				position = pushPosition.load(std::memory_order_relaxed);
+			}
+		}
+		return retVal;
+	}
+
+	/// @brief Returns if there is no item ready to be removed. Must only be called from the consumer thread.
+	/// @details The check is sequentially consistent, so a consumer that publishes that it is about to
+	/// sleep and then finds the buffer empty can rely on any later push seeing that it is asleep.
+	/// @returns True if pop would return false
+	bool is_empty() const
+	{
+		return slots[popPosition & (capacity - 1)].sequence.load(std::memory_order_seq_cst) != (popPosition + 1);
+	}
+
+	/// @brief Removes the item at the front of the buffer. Must only be called from the consumer thread.
+	/// @param[out] value The item that was removed
+	/// @returns True if an item was removed, false if the buffer is empty
+	bool pop(T &value)
+	{
+		bool retVal = false;
+		auto &slot = slots[popPosition & (capacity - 1)];
+
+		if (slot.sequence.load(std::memory_order_acquire) == (popPosition + 1))
+		{
+			value = std::move(slot.value);
+			slot.sequence.store(popPosition + capacity, std::memory_order_release);
+			popPosition++;
+			retVal = true;
+		}
+		return retVal;
+	}
+
+private:
+	/// @brief One entry of the buffer
+	struct Slot
+	{
+		std::atomic<std::size_t> sequence = { 0 }; ///< Equal to the push position when free, one past it when full
+		T value; ///< The stored item
+	};
+
+	std::unique_ptr<Slot[]> slots; ///< The entries, of which there are capacity
+	std::size_t capacity = 1; ///< The number of slots, always a power of two
+	std::atomic<std::size_t> pushPosition = { 0 }; ///< The position the next producer claims
+	std::size_t popPosition = 0; ///< The position the consumer reads next
+
+	LockFreeRingBuffer(const LockFreeRingBuffer &) = delete;
+	LockFreeRingBuffer &operator=(const LockFreeRingBuffer &) = delete;
+};
+
+#endif // LOCK_FREE_RING_BUFFER_HPP
@@ -14,32 +14,104 @@
 #include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
 
 #include "JuceHeader.h"
+#include "LockFreeRingBuffer.hpp"
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 /// @brief Defines a GUI component that will draw log info sunk from the stack
+/// @details Logging only copies the line into slots of a fixed size lock-free ring buffer, so the
+/// CAN stack never allocates or waits on the file or the GUI. A line too long for one slot is split
+/// over several, which the writer joins again. A background thread, which sleeps
+/// until a line is logged, drains the buffer in batches into the log file and a list of unshown
+/// lines. The component is told when lines are written and pulls them at most a few times per
+/// second, so nothing runs while nothing is logged.
+/// Only the rows that are visible in the viewport are drawn, and each line's glyphs are laid out
+/// once and reused until the component's width changes.
 class LoggerComponent : public Component
   , public FileLogger
   , public isobus::CANStackLogger
+  , private Timer
+  , private AsyncUpdater
 {
 public:
 	LoggerComponent();
+	~LoggerComponent() override;
 
 	void paint(Graphics &g) override;
+	void resized() override;
 
 	void sink_CAN_stack_log(LoggingLevel level, const std::string &logText) override;
 	static constexpr int HEIGHT = 200;
 
 	std::uint64_t initialPos() const;
 
+	/// @brief Writes every line logged so far to the log file, such as before the file is packaged
+	void flush_log_file();
+
 private:
+	/// @brief Periodically writes the logged lines to the log file
+	class LogWriterThread : public Thread
+	{
+	public:
+		explicit LogWriterThread(LoggerComponent &parentLogger);
+		~LogWriterThread() override;
+		void run() override;
+
+	private:
+		LoggerComponent &logger;
+	};
+
+	/// @brief A line, or a piece of a long line, as it is passed from the logging thread to the
+	/// writer thread without any allocation
+	struct LogRecord
+	{
+		std::array<char, 512> text; ///< The line, or this piece of it
+		std::size_t length = 0; ///< The number of characters in text
+		std::uint32_t lineID = 0; ///< Shared by every piece of a line, since lines from other threads can be logged in between
+		bool continued = false; ///< True if more pieces of the line follow this one
+		isobus::CANStackLogger::LoggingLevel logLevel = isobus::CANStackLogger::LoggingLevel::Info;
+	};
+
 	struct LogData
 	{
-		String logText;
-		isobus::CANStackLogger::LoggingLevel logLevel;
+		std::string logText;
+		isobus::CANStackLogger::LoggingLevel logLevel = isobus::CANStackLogger::LoggingLevel::Info;
+		std::unique_ptr<GlyphArrangement> glyphs; ///< The line's laid out text, created when it is first painted
 	};
+
+	void timerCallback() override;
+	void handleAsyncUpdate() override;
+	void show_unshown_messages();
+	void write_pending_messages();
+	bool has_pending_messages();
+
 	static constexpr std::size_t MAX_NUMBER_MESSAGES = 3000;
-	std::deque<LogData> loggedMessages;
+	static constexpr std::size_t LOG_BUFFER_CAPACITY = 2048; ///< Lines logged while the buffer is full are dropped
+	static constexpr int LINE_HEIGHT = 14;
+	static constexpr int WRITE_INTERVAL_MS = 50; ///< How long the writer collects lines after it wakes, before writing them
+	static constexpr std::uint32_t DISPLAY_INTERVAL_MS = 250; ///< The shortest time between the component pulling new lines
+
+	LockFreeRingBuffer<LogRecord> pendingMessages{ LOG_BUFFER_CAPACITY }; ///< Lines logged from any thread that have not been written yet
+	std::map<std::uint32_t, LogData> partialLines; ///< Long lines that are still missing pieces, by line ID. Only used while holding writeMutex
+	std::vector<LogData> unshownMessages; ///< Lines that were written but not pulled by the component yet, oldest first
+	std::deque<LogData> loggedMessages; ///< The lines the component shows, newest first
+	std::mutex writeMutex; ///< Makes sure only one thread drains pendingMessages at a time
+	std::mutex unshownMutex; ///< Protects unshownMessages
+	std::atomic<std::uint32_t> droppedMessageCount = { 0 }; ///< Lines dropped because the buffer was full
+	std::atomic<std::uint32_t> nextLineID = { 0 }; ///< The ID given to the pieces of the next logged line
+	std::atomic_bool writerWaitingForMessages = { false }; ///< True while the writer thread may sleep until a line is logged
 
+	const Font logFont{ FontOptions(14.0f) }; ///< The font every line is laid out with
+	int laidOutWidth = 0; ///< The width the cached glyphs were laid out for
+	std::uint32_t lastDisplayTime_ms = 0; ///< When the component last pulled new lines
 	std::uint64_t startPos = 0;
+	LogWriterThread writerThread; ///< Declared last so that it stops before anything it uses is destroyed
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoggerComponent)
 };
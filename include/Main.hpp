@@ -48,6 +48,7 @@ public:
 
 		std::uint8_t vtNumber = 0;
 		std::string screenCaptureDir;
+		bool headless = false;
 		for (const auto &arg : args)
 		{
 			if (arg.startsWith("--vt-number"))
@@ -64,9 +65,21 @@ public:
 			{
 				screenCaptureDir = arg.fromFirstOccurrenceOf("--screen-capture-dir=", false, false).toStdString();
 			}
+
+			if (arg == "--headless")
+			{
+				headless = true;
+			}
 		}
 
-		mainWindow.reset(new MainWindow(getApplicationNameWithBuildInfo(), logFile.currentLogFile(), vtNumber, screenCaptureDir));
+		if (headless)
+		{
+			headlessServer.reset(new HeadlessServer(logFile.currentLogFile(), vtNumber, screenCaptureDir));
+		}
+		else
+		{
+			mainWindow.reset(new MainWindow(getApplicationNameWithBuildInfo(), logFile.currentLogFile(), vtNumber, screenCaptureDir));
+		}
 	}
 
 	void shutdown() override
@@ -74,6 +87,7 @@ public:
 		// Add your application's shutdown code here..
 
 		mainWindow = nullptr; // (deletes our window)
+		headlessServer = nullptr;
 	}
 
 	//==============================================================================
@@ -143,7 +157,47 @@ public:
 		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainWindow)
 	};
 
+	//==============================================================================
+	/*
+        This class runs the VT server without any window, for use with the --headless
+        command line argument. Masks are only ever drawn into offscreen images,
+        such as when a client requests a screen capture.
+    */
+	class HeadlessServer
+	{
+	public:
+		/**
+     * @brief HeadlessServer
+     * @param vtNumberCmdLineArg - in the range of 1 - 32
+     * @param screenCaptureDir - path to the directory where the screen capture results will be saved
+     */
+		HeadlessServer(const std::string &canLogPath, int vtNumberCmdLineArg = 0, std::string screenCaptureDir = "");
+		~HeadlessServer();
+
+	private:
+		std::shared_ptr<isobus::InternalControlFunction> serverInternalControlFunction;
+		std::vector<std::shared_ptr<isobus::CANHardwarePlugin>> canDrivers;
+		std::unique_ptr<ServerMainComponent> server;
+
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HeadlessServer)
+	};
+
 private:
+	/**
+   * @brief Sets up the CAN drivers and the server's control function, and creates the server
+   * @param canDrivers - populated with the available CAN drivers, which must outlive the server
+   * @param serverInternalControlFunction - set to the server's control function
+   * @param vtNumberCmdLineArg - in the range of 1 - 32, or 0 to use the saved setting
+   * @param screenCaptureDir - path to the directory where the screen capture results will be saved
+   * @return the new server component, which the caller takes ownership of
+   */
+	static ServerMainComponent *create_server(std::vector<std::shared_ptr<isobus::CANHardwarePlugin>> &canDrivers,
+	                                          std::shared_ptr<isobus::InternalControlFunction> &serverInternalControlFunction,
+	                                          const std::string &canLogPath,
+	                                          int vtNumberCmdLineArg,
+	                                          std::string screenCaptureDir);
+
 	std::unique_ptr<MainWindow> mainWindow;
+	std::unique_ptr<HeadlessServer> headlessServer;
 	ASCIILogFile logFile;
 };
@@ -0,0 +1,68 @@
+//================================================================================================
+/// @file ObjectChangeTracker.hpp
+///
+/// @brief Defines a class that records which VT objects are touched by ECU to VT commands.
+/// @author The Open-Agriculture Developers
+///
+/// @copyright 2025 The Open-Agriculture Developers
+//================================================================================================
+#ifndef OBJECT_CHANGE_TRACKER_HPP
+#define OBJECT_CHANGE_TRACKER_HPP
+
+#include "isobus/isobus/can_internal_control_function.hpp"
+#include "isobus/isobus/can_message.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+/// @brief Watches the ECU to VT commands sent to the server, and records the IDs of the objects
+/// each one modifies, so that the GUI can update just the affected components when the server
+/// asks for a repaint instead of rebuilding every mask.
+class ObjectChangeTracker
+{
+public:
+	/// @brief The changes recorded for one client since they were last taken
+	struct Changes
+	{
+		std::set<std::uint16_t> objectIDs; ///< The objects named by a command, whose content or layout it changed
+		bool hasCommands = false; ///< True if any command that can cause a repaint was received
+		bool requiresFullRebuild = false; ///< True if a command changed something that can't be applied to individual objects
+		bool changedUnknownObjects = false; ///< True if a command, such as running a macro, may have changed objects that aren't in objectIDs
+		bool paletteChanged = false; ///< True if the client selected a different colour map or palette
+	};
+
+	ObjectChangeTracker() = default;
+	~ObjectChangeTracker();
+
+	/// @brief Starts listening to ECU to VT commands. Call this before the VT server is initialized
+	/// so that each command is recorded before the server processes it.
+	/// @param[in] serverControlFunction The VT server's control function
+	void initialize(std::shared_ptr<isobus::InternalControlFunction> serverControlFunction);
+
+	/// @brief Stops listening to ECU to VT commands
+	void terminate();
+
+	/// @brief Returns all changes recorded for a client and clears them
+	/// @param[in] client The client whose changes to return
+	/// @returns The changes recorded for the client since the last call
+	Changes take_changes(std::shared_ptr<isobus::ControlFunction> client);
+
+	/// @brief Discards all changes recorded for a client
+	/// @param[in] client The client whose changes to discard
+	void clear_changes(std::shared_ptr<isobus::ControlFunction> client);
+
+private:
+	/// @brief Processes an ECU to VT message from the network manager
+	/// @param[in] message The received message
+	/// @param[in] parentPointer A pointer to the tracker instance
+	static void process_rx_message(const isobus::CANMessage &message, void *parentPointer);
+
+	std::map<std::shared_ptr<isobus::ControlFunction>, Changes> pendingChanges; ///< Recorded changes, by client
+	std::shared_ptr<isobus::InternalControlFunction> serverInternalControlFunction; ///< The VT server's control function
+	std::mutex changesMutex; ///< Protects pendingChanges, which is written from the CAN stack's thread
+	bool initialized = false;
+};
+
+#endif // OBJECT_CHANGE_TRACKER_HPP
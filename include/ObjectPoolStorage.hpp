@@ -0,0 +1,204 @@
+//================================================================================================
+/// @file ObjectPoolStorage.hpp
+///
+/// @brief Defines the non-volatile storage of object pool versions saved by clients.
+/// @author The Open-Agriculture Developers
+///
+/// @copyright 2025 The Open-Agriculture Developers
+//================================================================================================
+#ifndef OBJECT_POOL_STORAGE_HPP
+#define OBJECT_POOL_STORAGE_HPP
+
+#include "isobus/isobus/can_NAME.hpp"
+
+#include "JuceHeader.h"
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <vector>
+
+/// @brief Stores the object pool versions that clients save with the Store Version command.
+/// @details Pool data is split into fixed size chunks, which are stored once in a directory shared
+/// by every client and named by the SHA-256 of their contents. Each client NAME gets its own
+/// directory with a manifest that maps each version label to the chunks of each part of the pool,
+/// along with the part's size and checksum. Saving data that is already stored writes nothing, and
+/// versions that share data share chunks. Chunks can be stored zlib compressed, which is done when
+/// it makes them smaller, and compressed chunks are decompressed straight into the loaded pool.
+///
+/// Manifests are read once, so listing and finding versions never needs to open the pool data.
+/// Every file is written to a temporary file, synced to the disk and renamed over the target.
+/// When a version's part count is known, its parts are staged until the last one arrives, and only
+/// then is the manifest written, once, to swap the whole version in. Losing power while a pool is
+/// saved therefore leaves the previous version intact rather than a truncated one. Pools saved as .iopx files
+/// before manifests existed are indexed the first time they are used, and are read from those
+/// files until the version is saved again or deleted. A manifest that can't be read is set aside
+/// instead of replaced, and from then on no chunk is deleted, since it may still refer to any of them.
+///
+/// Saving, deleting and clearing run one at a time. They only lock the index in memory to look up and
+/// swap in manifests, and write and sync their files without it, so listing versions never waits for
+/// them. Loading reads its files without the index locked too, and only waits while files are being
+/// deleted, which can't happen while a load may still be reading them. Clearing the storage keeps
+/// every reader waiting until the directory is gone.
+class ObjectPoolStorage
+{
+public:
+	static constexpr std::size_t VERSION_LABEL_LENGTH = 7; ///< The length of a version label, in bytes
+
+	/// @brief The label a client gives a saved version of its object pool
+	using VersionLabel = std::array<std::uint8_t, VERSION_LABEL_LENGTH>;
+
+	/// @brief Constructor, which reads the manifests of every client in the storage directory
+	/// @param[in] storageDirectory The directory with a subdirectory per client NAME
+	/// @param[in] openReadOnly True to only read the storage, such as from a tool while the server may be using it.
+	/// Nothing is then written or deleted: unused chunks are kept, directories without a manifest are indexed
+	/// in memory only, and saving, deleting and clearing fail.
+	explicit ObjectPoolStorage(const File &storageDirectory, bool openReadOnly = false);
+
+	/// @brief Returns the NAMEs of every client that has saved at least one version
+	/// @returns The client NAMEs
+	std::vector<isobus::NAME> get_clients();
+
+	/// @brief Returns the labels of the versions a client has saved, without waiting for a save in progress
+	/// @param[in] clientNAME The client's NAME
+	/// @returns The version labels, without duplicates
+	std::vector<VersionLabel> get_versions(isobus::NAME clientNAME);
+
+	/// @brief Reads a saved version of a client's object pool
+	/// @param[in] versionLabel The label of the version to load
+	/// @param[in] clientNAME The client's NAME
+	/// @returns The object pool data, or an empty vector if the version doesn't exist or is damaged
+	std::vector<std::uint8_t> load_version(const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME);
+
+	/// @brief Saves one part of a version of a client's object pool.
+	/// @details A pool that was uploaded in several parts is saved with one call per part, in order.
+	/// The parts of one version replace whatever was saved with that label before. When the part count
+	/// is known, calls with the same label and count are the parts of one version until all of them
+	/// are saved, and the version is stored in one go when the last part is saved. Otherwise, a call
+	/// continues the version if it was requested within STORE_SEQUENCE_TIMEOUT_MS of the previous part
+	/// finishing, and the version is stored as it is so far before each call returns. Either way, the
+	/// version it replaces is kept until the last part is saved, and is put back if any part fails.
+	/// @param[in] objectPool The object pool data to save
+	/// @param[in] versionLabel The label to save it under
+	/// @param[in] clientNAME The client's NAME
+	/// @param[in] expectedPartCount How many parts the version has, or 0 if that isn't known
+	/// @param[in] requestTime Millisecond counter when the client asked for the part to be saved
+	/// @returns True if the part was saved and, for the last part or without a part count, the version was stored
+	bool save_version(const std::vector<std::uint8_t> &objectPool,
+	                  const std::vector<std::uint8_t> &versionLabel,
+	                  isobus::NAME clientNAME,
+	                  std::size_t expectedPartCount = 0,
+	                  std::uint32_t requestTime = Time::getMillisecondCounter());
+
+	/// @brief Deletes a saved version of a client's object pool
+	/// @param[in] versionLabel The label of the version to delete
+	/// @param[in] clientNAME The client's NAME
+	/// @returns True if the version existed and was deleted, otherwise false
+	bool delete_version(const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME);
+
+	/// @brief Deletes every saved version of a client's object pool
+	/// @param[in] clientNAME The client's NAME
+	/// @returns True if any versions existed and were all deleted, otherwise false
+	bool delete_all_versions(isobus::NAME clientNAME);
+
+	/// @brief Sets if chunks that are saved from now on are compressed. Chunks that are already
+	/// stored stay as they are, and either kind of chunk can always be loaded.
+	/// @param[in] enabled True to compress new chunks, false to store them as they are
+	void set_compression_enabled(bool enabled);
+
+	/// @brief Deletes everything in the storage directory, for every client
+	/// @returns True if the storage directory was deleted
+	bool clear();
+
+	/// @brief Adds every saved part of the chosen clients' pools to a zip file as plain .iop files,
+	/// named iso_data/<client directory>/object_pool_<number>.iop
+	/// @param[in,out] packageBuilder The zip file to add the pools to
+	/// @param[in] includeClient Returns true for the names of the client directories to add
+	/// @returns True if any pools were added, otherwise false
+	bool add_to_package(ZipFile::Builder &packageBuilder, const std::function<bool(const String &)> &includeClient);
+
+private:
+	/// @brief One part of a saved version
+	struct StoredPart
+	{
+		/// @brief Returns if two parts are known to hold the same data without reading them
+		bool has_same_contents(const StoredPart &other) const;
+
+		VersionLabel label;
+		StringArray chunks; ///< The hashes of the chunks that hold the part, in order
+		String fileName; ///< The .iopx file that holds the part, if it was saved before chunks were used
+		std::int64_t size; ///< Size of the object pool data in the part
+		std::uint32_t checksum; ///< CRC-32 of the object pool data in the part
+	};
+
+	/// @brief Tracks the parts of a version that a client is in the middle of saving
+	struct StoreSequence
+	{
+		VersionLabel label;
+		std::vector<StoredPart> parts; ///< The parts whose chunks are stored, which the manifest only refers to once they are committed
+		std::vector<StoredPart> replacedParts; ///< The parts of the version this one replaces, which are kept until the sequence ends
+		std::size_t partsReceived = 0; ///< How many parts of the version have been requested so far
+		std::size_t expectedPartCount = 0; ///< How many parts the version has, or 0 if that isn't known
+		std::uint32_t lastPartTime = 0; ///< Millisecond counter when the last part finished saving
+		bool failed = false; ///< True if any part could not be saved, so the version is discarded
+		bool active = false;
+	};
+
+	/// @brief The index of everything a client has saved
+	struct ClientManifest
+	{
+		std::vector<StoredPart> parts; ///< Every stored part, in the order it was saved
+		StoreSequence store; ///< The version being saved
+	};
+
+	/// @brief Chooses parts to remove
+	using PartFilter = std::function<bool(const StoredPart &)>;
+
+	File get_client_directory(isobus::NAME clientNAME) const;
+	File get_chunk_file(const String &chunkHash, bool compressed) const;
+	bool write_chunk(const String &chunkHash, const std::uint8_t *data, std::size_t length);
+	ClientManifest &get_locked_manifest(isobus::NAME clientNAME);
+	ClientManifest &get_manifest(isobus::NAME clientNAME);
+	bool commit_parts(isobus::NAME clientNAME, ClientManifest &manifest, const VersionLabel &label, const std::vector<StoredPart> &parts);
+	bool finish_store(isobus::NAME clientNAME, ClientManifest &manifest);
+	bool store_chunks(const std::uint8_t *data, std::size_t length, StringArray &chunkHashes);
+	bool read_part(const File &clientDirectory, const StoredPart &part, std::uint8_t *destination) const;
+	bool read_chunk(const String &chunkHash, std::uint8_t *destination, std::size_t length) const;
+	bool remove_parts(isobus::NAME clientNAME, ClientManifest &manifest, const PartFilter &shouldRemove);
+	bool release_parts(const File &clientDirectory, const std::vector<StoredPart> &releasedParts);
+	void remove_unreferenced_chunks(const StringArray &chunkHashes);
+	static bool write_manifest(const File &clientDirectory, const std::vector<StoredPart> &parts);
+	static bool write_file_durably(const File &file, const void *data, std::size_t length);
+	static bool sync_directory(const File &directoryToSync);
+	static bool read_manifest(const File &clientDirectory, ClientManifest &manifest);
+	static ClientManifest index_directory(const File &clientDirectory);
+	static bool labels_match(const VersionLabel &label, const std::vector<std::uint8_t> &otherLabel);
+	static std::uint32_t calculate_checksum(const std::uint8_t *data, std::size_t length);
+
+	static constexpr const char *MANIFEST_FILE_NAME = "manifest.xml";
+	static constexpr const char *UNREADABLE_MANIFEST_FILE_NAME = "manifest_unreadable.xml";
+	static constexpr const char *UNREADABLE_MANIFEST_WILDCARD = "manifest_unreadable*.xml";
+	static constexpr const char *CHUNK_DIRECTORY_NAME = "chunks";
+	static constexpr const char *CHUNK_FILE_EXTENSION = ".chunk";
+	static constexpr const char *COMPRESSED_CHUNK_FILE_EXTENSION = ".chunkz";
+	static constexpr int MANIFEST_VERSION = 2;
+	static constexpr std::size_t CHUNK_SIZE = 64 * 1024; ///< The size of every chunk of a part except the last
+	static constexpr std::uint32_t STORE_SEQUENCE_TIMEOUT_MS = 500; ///< How long after a part is saved to wait for the next part, if the part count isn't known
+
+	const File directory; ///< Holds a subdirectory per client NAME
+	const File chunkDirectory; ///< Holds the chunks of every client's pools
+	std::map<std::uint64_t, ClientManifest> manifests; ///< Manifests that were read, by client NAME. The parts are only changed while saving or deleting.
+	std::map<String, bool> knownChunks; ///< The hashes of the chunks in the chunk directory, and if each one is compressed
+	mutable std::mutex indexMutex; ///< Protects manifests, knownChunks and chunkRemovalDisabled, and is never held while writing files
+	std::mutex writeMutex; ///< Makes saving, deleting and clearing run one at a time
+	std::shared_mutex fileRemovalMutex; ///< Held shared while files are read without the index, and exclusively while files are deleted
+	const bool readOnly; ///< True if nothing in the storage directory may be changed
+	std::atomic_bool compressionEnabled = { false }; ///< If new chunks are compressed
+	bool chunkRemovalDisabled = false; ///< True if a client has a manifest that couldn't be read, whose chunks must be kept
+};
+
+#endif // OBJECT_POOL_STORAGE_HPP
@@ -0,0 +1,120 @@
+//================================================================================================
+/// @file ObjectPoolStorageWorker.hpp
+///
+/// @brief Defines a background thread that does the file system work of saving and deleting pools.
+/// @author The Open-Agriculture Developers
+///
+/// @copyright 2025 The Open-Agriculture Developers
+//================================================================================================
+#ifndef OBJECT_POOL_STORAGE_WORKER_HPP
+#define OBJECT_POOL_STORAGE_WORKER_HPP
+
+#include "ObjectPoolStorage.hpp"
+
+#include "JuceHeader.h"
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// @brief Runs the save and delete operations of an ObjectPoolStorage on its own thread.
+/// @details Operations are queued and run one at a time, in the order they were queued, so the
+/// thread that processes CAN messages never waits on the file system to delete a pool. Saves are
+/// queued the same way to keep them in order, but the client is answered with their result, so
+/// Store Version still blocks its caller until its own save, and anything queued before it, is done.
+/// Each finished operation is added to a completion queue, which the message thread takes to
+/// report the result. The CAN thread reads the storage directly, which doesn't wait for a running
+/// save or delete except while files are being deleted, and uses is_delete_pending to leave out
+/// versions that are queued to be deleted. Readers that can wait, such as when
+/// packaging logs, call wait_until_idle first to see every operation that was queued before them.
+class ObjectPoolStorageWorker : private Thread
+{
+public:
+	/// @brief The kinds of operation the worker runs
+	enum class Operation
+	{
+		SaveVersion,
+		DeleteVersion,
+		DeleteAllVersions,
+		Clear
+	};
+
+	/// @brief The result of one finished operation
+	struct Completion
+	{
+		Operation operation;
+		isobus::NAME clientNAME;
+		std::vector<std::uint8_t> versionLabel; ///< Empty for DeleteAllVersions and Clear
+		bool succeeded;
+	};
+
+	/// @brief Constructor, which starts the worker thread
+	/// @param[in] storage The storage to run operations on, which must outlive the worker
+	explicit ObjectPoolStorageWorker(ObjectPoolStorage &storage);
+
+	/// @brief Destructor, which finishes every queued operation before stopping the thread
+	~ObjectPoolStorageWorker() override;
+
+	/// @brief Saves one part of a version of a client's object pool, once every operation queued before it has run.
+	/// @details Unlike the other operations this waits for its result, since the client is told whether the
+	/// version was stored when this returns.
+	/// @param[in] objectPool The object pool data to save, which is copied
+	/// @param[in] versionLabel The label to save it under
+	/// @param[in] clientNAME The client's NAME
+	/// @param[in] expectedPartCount How many parts the version has, or 0 if that isn't known
+	/// @returns True if the part was saved and, for the last part, the version is durably stored
+	bool save_version(const std::vector<std::uint8_t> &objectPool, const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME, std::size_t expectedPartCount);
+
+	/// @brief Queues deleting a saved version of a client's object pool
+	/// @param[in] versionLabel The label of the version to delete
+	/// @param[in] clientNAME The client's NAME
+	void delete_version(const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME);
+
+	/// @brief Queues deleting every saved version of a client's object pool
+	/// @param[in] clientNAME The client's NAME
+	void delete_all_versions(isobus::NAME clientNAME);
+
+	/// @brief Queues deleting everything in the storage, for every client
+	void clear();
+
+	/// @brief Returns if a version will be gone once the queued operations have run
+	/// @param[in] versionLabel The label of the version
+	/// @param[in] clientNAME The client's NAME
+	/// @returns True if a queued or running operation deletes the version
+	bool is_delete_pending(const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME);
+
+	/// @brief Blocks until every queued operation has finished
+	void wait_until_idle();
+
+	/// @brief Removes and returns the results of the operations that finished since the last call
+	/// @returns The results, in the order the operations finished
+	std::vector<Completion> take_completions();
+
+private:
+	/// @brief An operation waiting to run
+	struct Job
+	{
+		Operation operation;
+		isobus::NAME clientNAME;
+		std::vector<std::uint8_t> versionLabel;
+		std::vector<std::uint8_t> objectPool; ///< Only used by SaveVersion
+		std::uint32_t requestTime; ///< Millisecond counter when the job was queued
+		std::size_t expectedPartCount = 0; ///< Only used by SaveVersion
+		std::shared_ptr<std::promise<bool>> result; ///< Set when the job finishes, if someone waits for it
+	};
+
+	void run() override;
+	void queue_job(Job &&job);
+	bool run_next_job();
+
+	ObjectPoolStorage &storage;
+	std::deque<Job> jobs; ///< Operations waiting to run, oldest first, including the one that is running
+	std::vector<Completion> completions; ///< Operations that finished, waiting to be taken
+	std::mutex jobMutex; ///< Protects jobs and completions
+	std::condition_variable idleCondition; ///< Signalled when a queued job finishes
+};
+
+#endif // OBJECT_POOL_STORAGE_WORKER_HPP
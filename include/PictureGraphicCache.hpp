@@ -0,0 +1,91 @@
+//================================================================================================
+/// @file PictureGraphicCache.hpp
+///
+/// @brief Defines a process wide cache of decoded picture graphic images.
+/// @author The Open-Agriculture Developers
+///
+/// @copyright 2025 The Open-Agriculture Developers
+//================================================================================================
+#ifndef PICTURE_GRAPHIC_CACHE_HPP
+#define PICTURE_GRAPHIC_CACHE_HPP
+
+#include "isobus/isobus/isobus_virtual_terminal_objects.hpp"
+#include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
+
+#include "JuceHeader.h"
+#include "PictureGraphicDecoder.hpp"
+
+#include <list>
+#include <map>
+
+/// @brief Keeps decoded picture graphics around so that rebuilding a mask doesn't
+/// decode the same logos and icons again. Least recently used images are evicted
+/// once the total size of the cached images goes over the memory limit.
+class PictureGraphicCache
+{
+public:
+	/// @brief Returns a previously decoded image for a picture graphic
+	/// @param[in] workingSet The working set that owns the picture graphic
+	/// @param[in] pictureGraphic The picture graphic to find an image for
+	/// @returns The cached image, or an invalid (null) image if there is none
+	static Image find_image(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, const isobus::PictureGraphic &pictureGraphic);
+
+	/// @brief Adds a decoded image to the cache
+	/// @param[in] workingSet The working set that owns the picture graphic
+	/// @param[in] pictureGraphic The picture graphic that was decoded
+	/// @param[in] image The decoded image, already scaled to the picture graphic's width and height
+	static void store_image(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, const isobus::PictureGraphic &pictureGraphic, const Image &image);
+
+	/// @brief Returns the lookup table from palette index to pixel for a working set's current palette.
+	/// The table is only built once for each palette the working set selects.
+	/// @param[in] workingSet The working set whose palette to use
+	/// @returns The lookup table, with every colour fully opaque
+	static const PictureGraphicDecoder::ColourLookupTable &get_colour_lookup_table(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
+	/// @brief Discards the images of a working set because the colours they were decoded with changed
+	/// @param[in] workingSet The working set that selected a new colour map or palette
+	static void on_palette_changed(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
+	/// @brief Discards everything cached for a working set, such as when it disconnects or its pool is replaced
+	/// @param[in] workingSet The working set to remove
+	static void remove_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
+	/// @brief Sets the maximum number of bytes of image data to keep cached
+	/// @param[in] maximumBytes The new limit
+	static void set_memory_limit(std::size_t maximumBytes);
+
+private:
+	/// @brief Identifies one decoded image
+	struct ImageKey
+	{
+		bool operator<(const ImageKey &other) const;
+
+		const isobus::VirtualTerminalServerManagedWorkingSet *workingSet;
+		std::uint32_t paletteVersion;
+		std::uint16_t objectID;
+		std::uint16_t width;
+		std::uint16_t height;
+		std::uint8_t transparencyColour;
+		bool transparent;
+	};
+
+	struct CachedImage
+	{
+		ImageKey key;
+		Image image;
+		std::size_t sizeInBytes;
+	};
+
+	static ImageKey make_key(const isobus::VirtualTerminalServerManagedWorkingSet *workingSet, const isobus::PictureGraphic &pictureGraphic);
+	static void remove_images(const isobus::VirtualTerminalServerManagedWorkingSet *workingSet);
+	static void evict_to_limit();
+
+	static std::list<CachedImage> images; ///< Cached images, most recently used first
+	static std::map<ImageKey, std::list<CachedImage>::iterator> imageLookup;
+	static std::map<const isobus::VirtualTerminalServerManagedWorkingSet *, std::uint32_t> paletteVersions;
+	static std::map<const isobus::VirtualTerminalServerManagedWorkingSet *, PictureGraphicDecoder::ColourLookupTable> colourLookupTables;
+	static std::size_t totalSizeInBytes;
+	static std::size_t memoryLimitInBytes;
+};
+
+#endif // PICTURE_GRAPHIC_CACHE_HPP
@@ -0,0 +1,44 @@
+//================================================================================================
+/// @file PictureGraphicDecoder.hpp
+///
+/// @brief Defines functions to convert picture graphic pixel data into JUCE images.
+/// @author The Open-Agriculture Developers
+///
+/// @copyright 2025 The Open-Agriculture Developers
+//================================================================================================
+#ifndef PICTURE_GRAPHIC_DECODER_HPP
+#define PICTURE_GRAPHIC_DECODER_HPP
+
+#include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
+
+#include "JuceHeader.h"
+
+#include <array>
+
+/// @brief Converts palette indexed picture graphic data to ARGB images a whole row at a time,
+/// using a lookup table from palette index to the image's native pixel value.
+class PictureGraphicDecoder
+{
+public:
+	/// @brief Maps each palette index to a premultiplied pixel in the native ARGB layout
+	using ColourLookupTable = std::array<std::uint32_t, 256>;
+
+	/// @brief Builds a lookup table with every colour of a working set's current palette, fully opaque
+	/// @param[in] workingSet The working set whose palette to use
+	/// @returns The lookup table
+	static ColourLookupTable create_lookup_table(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
+
+	/// @brief Makes one palette index of a lookup table fully transparent
+	/// @param[in,out] lookupTable The table to modify
+	/// @param[in] transparencyColour The palette index to make transparent
+	static void set_transparent_colour(ColourLookupTable &lookupTable, std::uint8_t transparencyColour);
+
+	/// @brief Writes 8 bit per pixel palette indices into an ARGB image
+	/// @param[in] pixelData The palette indices, one byte per pixel, row by row
+	/// @param[in] pixelDataLength The number of bytes in pixelData
+	/// @param[in] lookupTable The colours to use for each palette index
+	/// @param[in,out] destination The ARGB image to write into, sized to the picture's actual width and height
+	static void decode_indexed_pixels(const std::uint8_t *pixelData, std::size_t pixelDataLength, const ColourLookupTable &lookupTable, Image &destination);
+};
+
+#endif // PICTURE_GRAPHIC_DECODER_HPP
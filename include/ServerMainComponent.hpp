@@ -2,7 +2,12 @@
 
 #include "ConfigureHardwareWindow.hpp"
 #include "DataMaskRenderAreaComponent.hpp"
+#include "LatencyMonitor.hpp"
+#include "LockFreeQueue.hpp"
 #include "LoggerComponent.hpp"
+#include "ObjectChangeTracker.hpp"
+#include "ObjectPoolStorage.hpp"
+#include "ObjectPoolStorageWorker.hpp"
 #include "SoftKeyMaskComponent.hpp"
 #include "SoftKeyMaskRenderAreaComponent.hpp"
 #include "VT_NumberComponent.hpp"
@@ -11,13 +16,14 @@
 #include "isobus/isobus/isobus_time_date_interface.hpp"
 #include "isobus/isobus/isobus_virtual_terminal_server.hpp"
 
-#include <filesystem>
+#include <atomic>
 #include <set>
 
 class ServerMainComponent : public juce::Component
   , public juce::KeyListener
   , public isobus::VirtualTerminalServer
   , public Timer
+  , public AsyncUpdater
   , public ApplicationCommandTarget
   , public MenuBarModel
 {
@@ -102,8 +108,10 @@ public:
 	std::uint8_t get_user_layout_softkeymask_bg_color() const override;
 
 	void timerCallback() override;
+	void handleAsyncUpdate() override;
 
 	void paint(juce::Graphics &g) override;
+	void paintOverChildren(juce::Graphics &g) override;
 	void resized() override;
 
 	ApplicationCommandTarget *getNextCommandTarget() override;
@@ -131,6 +139,14 @@ public:
 
 	void screen_capture(std::uint8_t item, std::uint8_t path, std::shared_ptr<isobus::ControlFunction> requestor) override;
 
+	/// @brief Draws the data/alarm mask and soft key mask areas into an offscreen image.
+	/// This works whether or not the component is on screen, such as when running headless.
+	/// @returns The rendered masks
+	Image render_masks_to_image();
+
+	/// @brief Starts the CAN interface if it isn't already running
+	void start_can_interface();
+
 	static std::string getAppDataDir();
 	/**
    * @brief minimum_height
@@ -153,7 +169,10 @@ private:
 		ClearISOData,
 		ConfigureCANHardware,
 		StartStop,
-		AutoStart
+		AutoStart,
+		ShowLatencyOverlay,
+		SaveLatencyReport,
+		ConfigureObjectPoolStorage
 	};
 
 	SoftKeyMaskDimensions softKeyMaskDimensions;
@@ -180,25 +199,69 @@ private:
 		bool isSoftKey;
 	};
 
-	static VTVersion get_version_from_setting(std::uint8_t aVersion);
+	/// @brief A change reported on the CAN stack's thread, which is applied in a batch on the message thread
+	struct UICommand
+	{
+		enum class Type
+		{
+			ValueChange, ///< Objects were changed, so the masks need to be updated
+			ChangeActiveMask ///< A working set changed its active data or alarm mask
+		};
+
+		Type type = Type::ValueChange;
+		std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet; ///< The working set the change applies to
+		std::uint16_t maskObjectID = isobus::NULL_OBJECT_ID; ///< The new active mask, for ChangeActiveMask
+	};
+
+	/// @brief Wakes the message thread up from the callbacks the server only gives as const,
+	/// such as when a pool is about to be parsed
+	class UpdatePoster : public AsyncUpdater
+	{
+	public:
+		explicit UpdatePoster(ServerMainComponent &parent) :
+		  mParent(parent){};
+
+		void handleAsyncUpdate() override;
 
-	std::size_t number_of_iop_files_in_directory(std::filesystem::path path);
+	private:
+		ServerMainComponent &mParent;
+	};
+	friend class UpdatePoster;
+
+	static VTVersion get_version_from_setting(std::uint8_t aVersion);
+	static void add_can_trace_to_package(ZipFile::Builder &packageBuilder, const File &traceFile, OwnedArray<TemporaryFile> &convertedTraces);
 
 	bool timeAndDateCallback(isobus::TimeDateInterface::TimeAndDate &timeAndDateToPopulate);
 	void transferred_object_pool_parse_start(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> &workingSet) const override;
 
+	void process_updates();
+	void drain_ui_commands();
+	void apply_active_mask_change(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> affectedWorkingSet, std::uint16_t newMask);
+	void schedule_next_update();
 	void on_change_active_mask_callback(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> affectedWorkingSet, std::uint16_t workingSet, std::uint16_t newMask);
 	void repaint_data_and_soft_key_mask();
+	void rebuild_data_and_soft_key_mask();
+	void update_changed_objects();
 	bool is_active_alarm_mask() const;
 	void update_ack_button_visibility();
 	void check_load_settings(std::shared_ptr<ValueTree> settings);
 	void remove_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSetToRemove);
 	void clear_iso_data();
+	void report_storage_completions();
+	void draw_latency_overlay(juce::Graphics &g);
+	void save_latency_report();
 
 	static constexpr int CAN_STATUS_INDICATOR_WIDTH = 150;
+	static constexpr std::uint32_t STATUS_MESSAGE_INTERVAL_MS = 1000; ///< How often the VT status message is sent, which is also the longest time between updates
+	static constexpr std::uint32_t MAINTENANCE_MESSAGE_TIMEOUT_MS = 3000; ///< A working set is removed if it sends no maintenance message for this long
+	static constexpr std::uint32_t HELD_BUTTON_REPEAT_INTERVAL_MS = 200; ///< How often a held button's still held message is sent
+	static constexpr std::uint32_t POOL_TRANSFER_UPDATE_INTERVAL_MS = 50; ///< How often the pool transfer progress indicators are updated
+	static constexpr std::uint32_t POOL_PARSE_POLL_INTERVAL_MS = 20; ///< How often a parsing pool is checked for completion, since the parser can't notify
 	const std::string ISO_DATA_PATH = "iso_data";
 	std::string screenCaptureDirArgument = "";
 	std::string canLogPath;
+	ObjectPoolStorage poolStorage;
+	ObjectPoolStorageWorker storageWorker; ///< Saves and deletes pools in poolStorage off the CAN thread
 
 	juce::ApplicationCommandManager mCommandManager;
 	WorkingSetSelectorComponent workingSetSelector;
@@ -206,6 +269,9 @@ private:
 	SoftKeyMaskRenderAreaComponent softKeyMaskRenderer;
 	MenuBarComponent menuBar;
 	LoggerComponent logger;
+	ObjectChangeTracker objectChangeTracker;
+	LatencyMonitor latencyMonitor;
+	LockFreeQueue<UICommand> uiCommands; ///< Changes from the CAN stack's thread, so that it never waits for the GUI
 	Viewport loggerViewport;
 	VT_NumberComponent vtNumberComponent;
 	SoundPlayer mSoundPlayer;
@@ -219,12 +285,16 @@ private:
 	std::vector<HeldButtonData> heldButtons;
 	std::set<std::string> loadedNames;
 	std::set<const isobus::VirtualTerminalServerManagedWorkingSet *> loadVersionResponsesSent;
+	mutable std::atomic_bool poolParsePending = { false }; ///< Set from the CAN stack's thread when a pool is about to be parsed
+	mutable UpdatePoster parseStartPoster = UpdatePoster(*this); ///< Runs an update as soon as a pool is about to be parsed
 	std::uint32_t alarmAckKeyMaskId = isobus::NULL_OBJECT_ID;
+	std::uint32_t latencyOverlayTimestamp_ms = 0; ///< When the latency overlay was last redrawn
 	int alarmAckKeyCode = juce::KeyPress::escapeKey;
 	std::uint8_t vtNumber = 1; // VT number in the range of 1-32
 	std::uint8_t numberOfPoolsToRender = 0;
 	VTVersion versionToReport = VTVersion::Version5;
 	bool needToRepaint = false;
+	bool needToRebuildMasks = false;
 	bool canAdapterConnected = false;
 	bool canInterfaceRunning = false;
 	bool autostart = false;
@@ -232,6 +302,9 @@ private:
 	bool alarmAckKeyPressed = false;
 	bool showAckButton = false;
 	bool saveIopBeforeParse = false;
+	bool binaryCanLog = false; ///< Whether the CAN log is written as a .cantrace instead of .asc on the next start
+	bool compressObjectPools = false; ///< Whether saved object pools are stored compressed
+	bool showLatencyOverlay = false; ///< Whether command latency percentiles are drawn over the data mask
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ServerMainComponent)
 };
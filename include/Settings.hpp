@@ -11,8 +11,10 @@ public:
 	bool load_settings();
 	std::shared_ptr<ValueTree> settingsValueTree();
 	int vt_number() const;
+	bool binary_can_log() const;
 
 private:
 	std::shared_ptr<ValueTree> m_settings;
 	int m_vtNumber = 1;
+	bool m_binaryCanLog = false;
 };
@@ -12,6 +12,7 @@
 #include "isobus/isobus/isobus_virtual_terminal_objects.hpp"
 #include "isobus/isobus/isobus_virtual_terminal_server_managed_working_set.hpp"
 
+#include "HitTestEngine.hpp"
 #include "JuceHeader.h"
 
 class ServerMainComponent;
@@ -25,6 +26,9 @@ public:
 
 	void on_working_set_disconnect(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet);
 
+	// Rebuilds the hit test index on the next query if the changed objects could have moved a key
+	void on_objects_changed(const std::set<std::uint16_t> &objectIDs);
+
 	void paint(Graphics &g) override;
 
 	// Used to calculate button press events
@@ -34,13 +38,12 @@ public:
 	void mouseUp(const MouseEvent &event) override;
 
 private:
-	std::shared_ptr<isobus::VTObject> getClickedChildRecursive(std::shared_ptr<isobus::VTObject> object, int x, int y);
-	static bool objectCanBeClicked(std::shared_ptr<isobus::VTObject> object);
-	static bool isClickWithinBounds(int clickXRelative, int clickYRelative, int objectX, int objectY, int objectWidth, int objectHeight);
+	void update_soft_key_layout();
 
 	std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> parentWorkingSet;
 	std::vector<std::shared_ptr<Component>> childComponents;
 	ServerMainComponent &ownerServer;
+	HitTestEngine hitTestEngine{ HitTestEngine::Layout::SoftKeyMask }; ///< Finds the keys of the active soft key mask
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SoftKeyMaskRenderAreaComponent)
 };
@@ -13,6 +13,8 @@
 
 #include "JuceHeader.h"
 
+#include <unordered_map>
+
 class TextDrawingComponent : public Component
   , private juce::Timer
 {
@@ -50,6 +52,26 @@ protected:
 	bool show = true;
 
 private:
+	/// @brief Returns the font to draw a font attributes object with, scaled so the reference character has the object's width
+	/// @details Configuring and measuring a font is costly enough to matter on masks with many text and number objects,
+	/// so each configuration is only set up the first time it is drawn.
+	/// @param[in] font The font attributes to draw with
+	/// @param[in] referenceCharForWidthCalc The character whose width is scaled to the font width
+	/// @returns The configured font
+	Font get_cached_font(const isobus::FontAttributes &font, char referenceCharForWidthCalc) const;
+
+	/// @brief The configured fonts, by height, width, style and reference character.
+	/// @details Every font attributes object with the same values shares an entry, and a changed object
+	/// simply uses a different one. Fonts are only drawn on the message thread, so there is no locking.
+	struct FontCache
+	{
+		std::unordered_map<std::uint32_t, Font> fonts;
+	};
+
+	static constexpr std::size_t MAXIMUM_CACHED_FONTS = 256; ///< The cache is emptied when it grows past this
+
+	SharedResourcePointer<FontCache> fontCache; ///< Shared by every text component, and freed along with the last one
+
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TextDrawingComponent)
 };
 
@@ -6,14 +6,63 @@
 #include "ASCIILogFile.hpp"
 
 #include "ServerMainComponent.hpp"
+#include "Settings.hpp"
 
-#include "isobus/utility/system_timing.hpp"
+#include "isobus/isobus/can_stack_logger.hpp"
 #include "isobus/utility/to_string.hpp"
 
-ASCIILogFile::ASCIILogFile()
+#include <algorithm>
+
+ASCIILogFile::FrameQueue::FrameQueue(int capacity) :
+  fifo(capacity),
+  buffer(static_cast<std::size_t>(capacity))
+{
+}
+
+bool ASCIILogFile::FrameQueue::push(const FrameRecord &frame)
 {
+	bool retVal = false;
+	auto scope = fifo.write(1);
+
+	if (1 == scope.blockSize1)
+	{
+		buffer[static_cast<std::size_t>(scope.startIndex1)] = frame;
+		retVal = true;
+	}
+	else if (1 == scope.blockSize2)
+	{
+		buffer[static_cast<std::size_t>(scope.startIndex2)] = frame;
+		retVal = true;
+	}
+	return retVal;
+}
+
+bool ASCIILogFile::FrameQueue::is_empty() const
+{
+	return 0 == fifo.getNumReady();
+}
+
+void ASCIILogFile::FrameQueue::pop_all(std::vector<FrameRecord> &destination)
+{
+	auto scope = fifo.read(fifo.getNumReady());
+
+	destination.insert(destination.end(), buffer.begin() + scope.startIndex1, buffer.begin() + scope.startIndex1 + scope.blockSize1);
+	destination.insert(destination.end(), buffer.begin() + scope.startIndex2, buffer.begin() + scope.startIndex2 + scope.blockSize2);
+}
+
+ASCIILogFile::ASCIILogFile() :
+  Thread("CAN Log Writer"),
+  receivedFrames(QUEUE_CAPACITY),
+  transmittedFrames(QUEUE_CAPACITY)
+{
+	Settings settings;
+	settings.load_settings();
+	binaryFormat = settings.binary_can_log();
+	pendingFrames.reserve(2 * QUEUE_CAPACITY);
+
 	auto currentTime = Time::getCurrentTime().toString(true, true, true, false);
 	initialTimestamp = Time::getCurrentTime();
+	initialTicks = Time::getHighResolutionTicks();
 	auto fileNameTime = currentTime;
 	fileNameTime = currentTime.replaceCharacter(' ', '_');
 	fileNameTime = currentTime.replaceCharacter(':', '_');
@@ -22,11 +71,11 @@ ASCIILogFile::ASCIILogFile()
 	               File::getSeparatorString() +
 	               "CANLog_" +
 	               fileNameTime +
-	               ".asc");
+	               (binaryFormat ? CANTraceFile::FILE_EXTENSION : ".asc"));
 
 	// Prune old log files
 	auto logDirectory = logFile.getParentDirectory();
-	auto childFiles = logDirectory.findChildFiles(File::findFiles, false, "*.asc");
+	auto childFiles = logDirectory.findChildFiles(File::findFiles, false, "*.asc;*" + String(CANTraceFile::FILE_EXTENSION));
 
 	for (auto &file : childFiles)
 	{
@@ -36,81 +85,169 @@ ASCIILogFile::ASCIILogFile()
 		}
 	}
 
-	// Write vector ascii header
 	if (logFile.hasWriteAccess())
 	{
-		logFile.appendText("date " + currentTime + "\n");
-		logFile.appendText("base hex timestamps absolute\n");
-		logFile.appendText("no internal events logged\n");
+		logStream = logFile.createOutputStream();
+	}
+
+	if ((nullptr != logStream) && logStream->openedOk())
+	{
+		std::string header;
+
+		if (binaryFormat)
+		{
+			CANTraceFile::append_header(header, initialTimestamp);
+		}
+		else
+		{
+			CANTraceFile::append_asc_header(header, initialTimestamp);
+		}
+		logStream->write(header.data(), header.size());
+		logStream->flush();
+
+		startThread();
 		canFrameReceivedListener = isobus::CANHardwareInterface::get_can_frame_received_event_dispatcher().add_listener([this](const isobus::CANMessageFrame &canFrame) {
-			logFile.appendText("   ");
-			auto currentTime = Time::getCurrentTime() - initialTimestamp;
-			auto milliseconds = isobus::to_string(currentTime.inMilliseconds() % 1000);
+			on_frame(canFrame, false);
+		});
+		canFrameSentListener = isobus::CANHardwareInterface::get_can_frame_transmitted_event_dispatcher().add_listener([this](const isobus::CANMessageFrame &canFrame) {
+			on_frame(canFrame, true);
+		});
+	}
+	else
+	{
+		logStream.reset();
+		RuntimePermissions::request(RuntimePermissions::writeExternalStorage, nullptr);
+	}
+}
 
-			while (milliseconds.length() < 3)
-			{
-				milliseconds = "0" + milliseconds;
-			}
+ASCIILogFile::~ASCIILogFile()
+{
+	// Stop taking new frames, then let the writer thread write out what is still queued
+	canFrameReceivedListener.reset();
+	canFrameSentListener.reset();
+	stopThread(2000);
+}
 
-			logFile.appendText(isobus::to_string(std::floor(currentTime.inSeconds())) +
-			                   "." +
-			                   milliseconds +
-			                   "000 1  " +
-			                   String::toHexString(canFrame.identifier).toUpperCase().toStdString() +
-			                   "x       Rx   d " +
-			                   isobus::to_string(static_cast<int>(canFrame.dataLength)) +
-			                   " ");
+std::string ASCIILogFile::currentLogFile() const
+{
+	return logFile.getFullPathName().toStdString();
+}
 
-			for (std::uint_fast8_t i = 0; i < canFrame.dataLength; i++)
-			{
-				logFile.appendText(String::toHexString(canFrame.data[i]).paddedLeft('0', 2).toUpperCase().toStdString() + " ");
-			}
+void ASCIILogFile::run()
+{
+	lastSyncTime = Time::getMillisecondCounter();
 
-			for (std::uint_fast8_t i = canFrame.dataLength; i < 8; i++)
-			{
-				logFile.appendText("00 ");
-			}
-			logFile.appendText("\n");
-		});
+	while (!threadShouldExit())
+	{
+		write_queued_frames();
 
-		canFrameSentListener = isobus::CANHardwareInterface::get_can_frame_transmitted_event_dispatcher().add_listener([this](const isobus::CANMessageFrame &canFrame) {
-			logFile.appendText("   ");
-			auto currentTime = Time::getCurrentTime() - initialTimestamp;
-			auto milliseconds = isobus::to_string(currentTime.inMilliseconds() % 1000);
+		// The flag is set before the queues are checked, so a frame queued in between still wakes the thread
+		writerWaitingForFrames = true;
 
-			while (milliseconds.length() < 3)
-			{
-				milliseconds = "0" + milliseconds;
-			}
+		if (receivedFrames.is_empty() && transmittedFrames.is_empty())
+		{
+			wait(get_time_until_sync_ms());
+			sync_if_due();
+		}
+		writerWaitingForFrames = false;
+
+		// Frames are collected for a while before they are written, so a busy bus is written in batches
+		if (!threadShouldExit())
+		{
+			wait(WRITE_INTERVAL_MS);
+		}
+	}
 
-			logFile.appendText(isobus::to_string(std::floor(currentTime.inSeconds())) +
-			                   "." +
-			                   milliseconds +
-			                   "000 1  " +
-			                   String::toHexString(canFrame.identifier).toUpperCase().toStdString() +
-			                   "x       Tx   d " +
-			                   isobus::to_string(static_cast<int>(canFrame.dataLength)) +
-			                   " ");
+	// Catch any frames that arrived between the last write and the listeners being removed, and sync them as the log closes
+	write_queued_frames();
 
-			for (std::uint_fast8_t i = 0; i < canFrame.dataLength; i++)
+	if (unsyncedFrames)
+	{
+		logStream->flush();
+		unsyncedFrames = false;
+	}
+}
+
+void ASCIILogFile::on_frame(const isobus::CANMessageFrame &canFrame, bool transmitted)
+{
+	FrameRecord frame;
+	frame.timestampUs = static_cast<std::uint64_t>(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - initialTicks) * 1000000.0);
+	frame.identifier = canFrame.identifier;
+	frame.dataLength = static_cast<std::uint8_t>(std::min<std::size_t>(canFrame.dataLength, sizeof(frame.data)));
+	frame.transmitted = transmitted;
+	std::copy_n(canFrame.data, sizeof(frame.data), frame.data);
+
+	auto &queue = transmitted ? transmittedFrames : receivedFrames;
+
+	if (!queue.push(frame))
+	{
+		droppedFrameCount++;
+	}
+	else if (writerWaitingForFrames.exchange(false))
+	{
+		notify();
+	}
+}
+
+void ASCIILogFile::write_queued_frames()
+{
+	pendingFrames.clear();
+	receivedFrames.pop_all(pendingFrames);
+	auto receivedFrameCount = static_cast<std::ptrdiff_t>(pendingFrames.size());
+	transmittedFrames.pop_all(pendingFrames);
+
+	// Each queue is already in time order, so interleave them to keep the file in time order too
+	std::inplace_merge(pendingFrames.begin(), pendingFrames.begin() + receivedFrameCount, pendingFrames.end(), [](const FrameRecord &first, const FrameRecord &second) {
+		return first.timestampUs < second.timestampUs;
+	});
+
+	if (!pendingFrames.empty())
+	{
+		formattedFrames.clear();
+
+		for (const auto &frame : pendingFrames)
+		{
+			if (binaryFormat)
 			{
-				logFile.appendText(String::toHexString(canFrame.data[i]).paddedLeft('0', 2).toUpperCase().toStdString() + " ");
+				CANTraceFile::append_record(formattedFrames, frame);
 			}
-
-			for (std::uint_fast8_t i = canFrame.dataLength; i < 8; i++)
+			else
 			{
-				logFile.appendText("00 ");
+				CANTraceFile::append_asc_line(formattedFrames, frame);
 			}
-			logFile.appendText("\n");
-		});
+		}
+		// Flushing a FileOutputStream also syncs it to the disk, so that is left to sync_if_due
+		logStream->write(formattedFrames.data(), formattedFrames.size());
+		unsyncedFrames = true;
 	}
-	else
+	sync_if_due();
+
+	auto droppedFrames = droppedFrameCount.exchange(0);
+
+	if (0 != droppedFrames)
 	{
-		RuntimePermissions::request(RuntimePermissions::writeExternalStorage, nullptr);
+		isobus::CANStackLogger::warn("[CAN Log]: The log file could not keep up, " + isobus::to_string(droppedFrames) + " frames were not logged");
 	}
 }
 
-std::string ASCIILogFile::currentLogFile() const
+void ASCIILogFile::sync_if_due()
 {
-	return logFile.getFullPathName().toStdString();
+	if (unsyncedFrames && (0 == get_time_until_sync_ms()))
+	{
+		logStream->flush();
+		lastSyncTime = Time::getMillisecondCounter();
+		unsyncedFrames = false;
+	}
+}
+
+int ASCIILogFile::get_time_until_sync_ms() const
+{
+	int retVal = -1;
+
+	if (unsyncedFrames)
+	{
+		auto elapsed = Time::getMillisecondCounter() - lastSyncTime;
+		retVal = (elapsed >= SYNC_INTERVAL_MS) ? 0 : static_cast<int>(SYNC_INTERVAL_MS - elapsed);
+	}
+	return retVal;
 }
@@ -0,0 +1,172 @@
+/*******************************************************************************
+** @file       CANTraceFile.cpp
+** @author     The Open-Agriculture Developers
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "CANTraceFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	constexpr char TRACE_MAGIC[] = "AGVTCANT";
+	constexpr std::size_t TRACE_MAGIC_LENGTH = 8;
+	constexpr std::uint8_t TRANSMITTED_FLAG = 0x01;
+	constexpr std::size_t EXPORT_CHUNK_SIZE = 64 * 1024;
+	constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+
+	void append_little_endian(std::string &destination, std::uint64_t value, std::size_t numberOfBytes)
+	{
+		for (std::size_t i = 0; i < numberOfBytes; i++)
+		{
+			destination += static_cast<char>((value >> (8 * i)) & 0xFF);
+		}
+	}
+
+	std::uint64_t read_little_endian(const std::uint8_t *source, std::size_t numberOfBytes)
+	{
+		std::uint64_t retVal = 0;
+
+		for (std::size_t i = 0; i < numberOfBytes; i++)
+		{
+			retVal |= static_cast<std::uint64_t>(source[i]) << (8 * i);
+		}
+		return retVal;
+	}
+
+	void append_hex_byte(std::string &destination, std::uint8_t value)
+	{
+		destination += HEX_DIGITS[value >> 4];
+		destination += HEX_DIGITS[value & 0x0F];
+	}
+
+	/// @brief Appends a number in upper case hex without any leading zeros
+	void append_hex_identifier(std::string &destination, std::uint32_t value)
+	{
+		int shift = 28;
+
+		while ((shift > 0) && (0 == ((value >> shift) & 0x0F)))
+		{
+			shift -= 4;
+		}
+
+		for (; shift >= 0; shift -= 4)
+		{
+			destination += HEX_DIGITS[(value >> shift) & 0x0F];
+		}
+	}
+
+	/// @brief Appends a number padded with leading zeros to a number of digits
+	void append_padded_decimal(std::string &destination, std::uint64_t value, std::size_t digits)
+	{
+		auto text = std::to_string(value);
+
+		if (text.length() < digits)
+		{
+			destination.append(digits - text.length(), '0');
+		}
+		destination += text;
+	}
+}
+
+void CANTraceFile::append_header(std::string &destination, Time startTime)
+{
+	destination.append(TRACE_MAGIC, TRACE_MAGIC_LENGTH);
+	append_little_endian(destination, FORMAT_VERSION, 2);
+	append_little_endian(destination, RECORD_SIZE, 2);
+	append_little_endian(destination, 0, 4);
+	append_little_endian(destination, static_cast<std::uint64_t>(startTime.toMilliseconds()), 8);
+}
+
+void CANTraceFile::append_record(std::string &destination, const Record &record)
+{
+	append_little_endian(destination, record.timestampUs, 8);
+	append_little_endian(destination, record.identifier, 4);
+	append_little_endian(destination, record.dataLength, 1);
+	append_little_endian(destination, record.transmitted ? TRANSMITTED_FLAG : 0, 1);
+	append_little_endian(destination, 0, 2);
+
+	for (std::uint_fast8_t i = 0; i < sizeof(record.data); i++)
+	{
+		destination += static_cast<char>((i < record.dataLength) ? record.data[i] : 0);
+	}
+}
+
+void CANTraceFile::append_asc_header(std::string &destination, Time startTime)
+{
+	// Lines end in CRLF, the same as the File::appendText calls that used to write the log
+	destination += "date " + startTime.toString(true, true, true, false).toStdString() + "\r\n";
+	destination += "base hex timestamps absolute\r\n";
+	destination += "no internal events logged\r\n";
+}
+
+void CANTraceFile::append_asc_line(std::string &destination, const Record &record)
+{
+	destination += "   ";
+	destination += std::to_string(record.timestampUs / 1000000);
+	destination += ".";
+	append_padded_decimal(destination, record.timestampUs % 1000000, 6);
+	destination += " 1  ";
+	append_hex_identifier(destination, record.identifier);
+	destination += record.transmitted ? "x       Tx   d " : "x       Rx   d ";
+	destination += std::to_string(static_cast<int>(record.dataLength));
+	destination += " ";
+
+	for (std::uint_fast8_t i = 0; i < record.dataLength; i++)
+	{
+		append_hex_byte(destination, record.data[i]);
+		destination += " ";
+	}
+
+	for (std::uint_fast8_t i = record.dataLength; i < 8; i++)
+	{
+		destination += "00 ";
+	}
+	destination += "\r\n";
+}
+
+bool CANTraceFile::export_to_asc(const File &traceFile, OutputStream &destination)
+{
+	bool retVal = false;
+	MemoryMappedFile mappedTrace(traceFile, MemoryMappedFile::readOnly);
+	auto traceData = static_cast<const std::uint8_t *>(mappedTrace.getData());
+	auto traceSize = mappedTrace.getSize();
+
+	if ((nullptr != traceData) &&
+	    (traceSize >= HEADER_SIZE) &&
+	    (0 == std::memcmp(traceData, TRACE_MAGIC, TRACE_MAGIC_LENGTH)))
+	{
+		auto version = static_cast<std::uint16_t>(read_little_endian(traceData + 8, 2));
+		auto recordSize = static_cast<std::size_t>(read_little_endian(traceData + 10, 2));
+		auto startTime = Time(static_cast<std::int64_t>(read_little_endian(traceData + 16, 8)));
+
+		// Newer versions may only ever add fields to the end of a record
+		if ((version >= 1) && (recordSize >= RECORD_SIZE))
+		{
+			std::string text;
+			append_asc_header(text, startTime);
+
+			// A partly written record at the end of a trace that is still open is left out
+			for (std::size_t offset = HEADER_SIZE; (offset + recordSize) <= traceSize; offset += recordSize)
+			{
+				const std::uint8_t *recordData = traceData + offset;
+				Record record;
+				record.timestampUs = read_little_endian(recordData, 8);
+				record.identifier = static_cast<std::uint32_t>(read_little_endian(recordData + 8, 4));
+				record.dataLength = std::min<std::uint8_t>(recordData[12], sizeof(record.data));
+				record.transmitted = (0 != (recordData[13] & TRANSMITTED_FLAG));
+				std::memcpy(record.data, recordData + 16, sizeof(record.data));
+				append_asc_line(text, record);
+
+				if (text.size() >= EXPORT_CHUNK_SIZE)
+				{
+					destination.write(text.data(), text.size());
+					text.clear();
+				}
+			}
+			retVal = destination.write(text.data(), text.size());
+		}
+	}
+	return retVal;
+}
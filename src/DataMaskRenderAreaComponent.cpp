@@ -11,13 +11,18 @@
 DataMaskRenderAreaComponent::DataMaskRenderAreaComponent(ServerMainComponent &parentServer) :
   ownerServer(parentServer)
 {
+	setWantsKeyboardFocus(true);
 }
 
 void DataMaskRenderAreaComponent::on_change_active_mask(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
 {
 	needToRepaintActiveArea = false;
+
+	// Masks are owned by the component cache, so they need to be detached rather than destroyed
+	removeAllChildren();
 	childComponents.clear();
 	parentWorkingSet = workingSet;
+	hitTestEngine.set_working_set(parentWorkingSet);
 
 	if (parentWorkingSet)
 	{
@@ -26,7 +31,7 @@ void DataMaskRenderAreaComponent::on_change_active_mask(std::shared_ptr<isobus::
 		if ((nullptr != workingSetObject) && (isobus::NULL_OBJECT_ID != workingSetObject->get_active_mask()))
 		{
 			auto activeMask = parentWorkingSet->get_object_by_id(workingSetObject->get_active_mask());
-			childComponents.emplace_back(JuceManagedWorkingSetCache::create_component(parentWorkingSet, activeMask));
+			childComponents.emplace_back(JuceManagedWorkingSetCache::get_mask_component(parentWorkingSet, activeMask));
 
 			if (nullptr != childComponents.back())
 			{
@@ -41,12 +46,19 @@ void DataMaskRenderAreaComponent::on_working_set_disconnect(std::shared_ptr<isob
 {
 	if ((nullptr != workingSet) && (parentWorkingSet == workingSet))
 	{
+		removeAllChildren();
 		childComponents.clear();
 		parentWorkingSet.reset();
+		hitTestEngine.set_working_set(nullptr);
 		repaint();
 	}
 }
 
+void DataMaskRenderAreaComponent::on_objects_changed(const std::set<std::uint16_t> &objectIDs)
+{
+	hitTestEngine.on_objects_changed(objectIDs);
+}
+
 void DataMaskRenderAreaComponent::paint(Graphics &g)
 {
 	g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
@@ -73,15 +85,13 @@ void DataMaskRenderAreaComponent::mouseDown(const MouseEvent &event)
 {
 	if (nullptr != parentWorkingSet)
 	{
-		// Do a top down search to see if they clicked on some interactable object
-		auto workingSetObject = std::static_pointer_cast<isobus::WorkingSet>(parentWorkingSet->get_working_set_object());
+		// Look up the interactable object they clicked on, if any
+		auto activeMask = hitTestEngine.get_displayed_mask();
 
-		if (nullptr != workingSetObject)
+		if (nullptr != activeMask)
 		{
-			auto activeMask = parentWorkingSet->get_object_by_id(workingSetObject->get_active_mask());
-
 			auto relativeEvent = event.getEventRelativeTo(this);
-			auto clickedObject = getClickedChildRecursive(activeMask, relativeEvent.getMouseDownX(), relativeEvent.getMouseDownY());
+			auto clickedObject = hitTestEngine.find(relativeEvent.getMouseDownX(), relativeEvent.getMouseDownY());
 
 			std::uint8_t keyCode = 1;
 
@@ -122,15 +132,13 @@ void DataMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 {
 	if (nullptr != parentWorkingSet)
 	{
-		// Do a top down search to see if they clicked on some interactable object
-		auto workingSetObject = std::static_pointer_cast<isobus::WorkingSet>(parentWorkingSet->get_working_set_object());
+		// Look up the interactable object they clicked on, if any
+		auto activeMask = hitTestEngine.get_displayed_mask();
 
-		if (nullptr != workingSetObject)
+		if (nullptr != activeMask)
 		{
-			auto activeMask = parentWorkingSet->get_object_by_id(workingSetObject->get_active_mask());
-
 			auto relativeEvent = event.getEventRelativeTo(this);
-			auto clickedObject = getClickedChildRecursive(activeMask, relativeEvent.getMouseDownX(), relativeEvent.getMouseDownY());
+			auto clickedObject = hitTestEngine.find(relativeEvent.getMouseDownX(), relativeEvent.getMouseDownY());
 
 			std::uint8_t keyCode = 1;
 
@@ -381,6 +389,7 @@ void DataMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 									}
 
 									this->needToRepaintActiveArea = true;
+									ownerServer.repaint_on_next_update();
 								}
 								inputNumberListener.set_target(nullptr);
 								inputNumberModal.reset();
@@ -523,6 +532,7 @@ void DataMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 										ownerServer.process_macro(clickedString, isobus::EventID::OnChangeValue, isobus::VirtualTerminalObjectType::InputString, parentWorkingSet);
 									}
 									needToRepaintActiveArea = true;
+									ownerServer.repaint_on_next_update();
 								}
 								inputStringModal->exitModalState();
 								inputStringModal.reset();
@@ -551,6 +561,27 @@ void DataMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 	}
 }
 
+bool DataMaskRenderAreaComponent::keyPressed(const KeyPress &key)
+{
+	bool retVal = false;
+
+	if ((nullptr != parentWorkingSet) && (KeyPress::tabKey == key.getKeyCode()))
+	{
+		auto nextObjectID = hitTestEngine.get_next_in_navigation_order(parentWorkingSet->get_object_focus(), !key.getModifiers().isShiftDown());
+
+		if (isobus::NULL_OBJECT_ID != nextObjectID)
+		{
+			parentWorkingSet->set_object_focus(nextObjectID);
+			ownerServer.send_select_input_object_message(nextObjectID, true, false, ownerServer.get_client_control_function_for_working_set(parentWorkingSet));
+			ownerServer.repaint_on_next_update();
+			repaint();
+		}
+		retVal = true;
+	}
+	// Other keys are left to the server's key listener, which handles the alarm acknowledge key
+	return retVal;
+}
+
 bool DataMaskRenderAreaComponent::needsRepaint() const
 {
 	return needToRepaintActiveArea;
@@ -590,98 +621,3 @@ void DataMaskRenderAreaComponent::InputNumberListener::set_target(std::shared_pt
 {
 	targetObject = objectBeingModified;
 }
-
-std::shared_ptr<isobus::VTObject> DataMaskRenderAreaComponent::getClickedChildRecursive(std::shared_ptr<isobus::VTObject> object, int x, int y)
-{
-	std::shared_ptr<isobus::VTObject> retVal;
-
-	if ((nullptr == object) ||
-	    (nullptr == parentWorkingSet) ||
-	    ((isobus::VirtualTerminalObjectType::ObjectPointer != object->get_object_type()) &&
-	     (0 == object->get_number_children())))
-	{
-		return nullptr;
-	}
-
-	if (isobus::VirtualTerminalObjectType::ObjectPointer == object->get_object_type())
-	{
-		auto child = object->get_object_by_id(std::static_pointer_cast<isobus::ObjectPointer>(object)->get_value(), parentWorkingSet->get_object_tree());
-
-		if ((nullptr != child) &&
-		    (objectCanBeClicked(child)) &&
-		    (isClickWithinBounds(x, y, 0, 0, child->get_width(), child->get_height())))
-		{
-			return child;
-		}
-		else if (!objectCanBeClicked(child))
-		{
-			retVal = getClickedChildRecursive(child, x, y);
-		}
-	}
-	else
-	{
-		// none of the childs of the hidden containers should send clicked events
-		if (isobus::VirtualTerminalObjectType::Container == object->get_object_type() &&
-		    std::static_pointer_cast<const isobus::Container>(object)->get_hidden())
-		{
-			return nullptr;
-		}
-
-		for (std::uint16_t i = 0; i < object->get_number_children(); i++)
-		{
-			auto child = object->get_object_by_id(object->get_child_id(i), parentWorkingSet->get_object_tree());
-
-			if ((nullptr != child) &&
-			    (objectCanBeClicked(child)) &&
-			    (isClickWithinBounds(x, y, object->get_child_x(i), object->get_child_y(i), child->get_width(), child->get_height())))
-			{
-				return child;
-			}
-			else if (!objectCanBeClicked(child))
-			{
-				retVal = getClickedChildRecursive(child, x - object->get_child_x(i), y - object->get_child_y(i));
-
-				if (nullptr != retVal)
-				{
-					break;
-				}
-			}
-		}
-	}
-	return retVal;
-}
-
-bool DataMaskRenderAreaComponent::objectCanBeClicked(std::shared_ptr<isobus::VTObject> object)
-{
-	bool retVal = false;
-
-	if (nullptr != object)
-	{
-		switch (object->get_object_type())
-		{
-			case isobus::VirtualTerminalObjectType::Button:
-			case isobus::VirtualTerminalObjectType::InputList:
-			case isobus::VirtualTerminalObjectType::Key:
-			case isobus::VirtualTerminalObjectType::InputNumber:
-			case isobus::VirtualTerminalObjectType::InputBoolean:
-			case isobus::VirtualTerminalObjectType::InputString:
-			{
-				retVal = true;
-			}
-			break;
-
-			default:
-			{
-				retVal = false;
-			}
-			break;
-		}
-	}
-	return retVal;
-}
-
-bool DataMaskRenderAreaComponent::isClickWithinBounds(int clickXRelative, int clickYRelative, int objectX, int objectY, int objectWidth, int objectHeight)
-{
-	return ((clickXRelative >= objectX) && (clickXRelative <= (objectX + objectWidth))) &&
-	  ((clickYRelative >= objectY) && (clickYRelative <= (objectY + objectHeight)));
-}
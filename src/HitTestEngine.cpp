@@ -0,0 +1,234 @@
+/*******************************************************************************
+** @file       HitTestEngine.cpp
+** @author     The Open-Agriculture Developers
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "HitTestEngine.hpp"
+#include "SoftKeyMaskComponent.hpp"
+
+#include <algorithm>
+
+HitTestEngine::HitTestEngine(Layout layout) :
+  layout(layout)
+{
+}
+
+void HitTestEngine::set_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> newWorkingSet)
+{
+	workingSet = newWorkingSet;
+	indexValid = false;
+
+	if (nullptr == workingSet)
+	{
+		index.clear();
+		navigationOrder.clear();
+		indexedMaskID = isobus::NULL_OBJECT_ID;
+	}
+}
+
+void HitTestEngine::set_soft_key_layout(int keyWidth, int keyHeight, int columns, int rows)
+{
+	if ((keyWidth != softKeyWidth) || (keyHeight != softKeyHeight) || (columns != softKeyColumns) || (rows != softKeyRows))
+	{
+		softKeyWidth = keyWidth;
+		softKeyHeight = keyHeight;
+		softKeyColumns = std::max(columns, 1);
+		softKeyRows = std::max(rows, 1);
+		indexValid = false;
+	}
+}
+
+void HitTestEngine::on_objects_changed(const std::set<std::uint16_t> &objectIDs)
+{
+	if (indexValid && index.depends_on_any(objectIDs))
+	{
+		indexValid = false;
+	}
+}
+
+std::shared_ptr<isobus::VTObject> HitTestEngine::get_displayed_mask() const
+{
+	std::shared_ptr<isobus::VTObject> retVal;
+
+	if (nullptr != workingSet)
+	{
+		auto workingSetObject = std::static_pointer_cast<isobus::WorkingSet>(workingSet->get_working_set_object());
+
+		if ((nullptr != workingSetObject) && (isobus::NULL_OBJECT_ID != workingSetObject->get_active_mask()))
+		{
+			retVal = workingSet->get_object_by_id(workingSetObject->get_active_mask());
+		}
+	}
+
+	if ((Layout::SoftKeyMask == layout) && (nullptr != retVal))
+	{
+		std::uint16_t softKeyMaskID = isobus::NULL_OBJECT_ID;
+
+		if (isobus::VirtualTerminalObjectType::AlarmMask == retVal->get_object_type())
+		{
+			softKeyMaskID = std::static_pointer_cast<isobus::AlarmMask>(retVal)->get_soft_key_mask();
+		}
+		else if (isobus::VirtualTerminalObjectType::DataMask == retVal->get_object_type())
+		{
+			softKeyMaskID = std::static_pointer_cast<isobus::DataMask>(retVal)->get_soft_key_mask();
+		}
+		retVal = workingSet->get_object_by_id(softKeyMaskID);
+
+		if ((nullptr != retVal) && (isobus::VirtualTerminalObjectType::SoftKeyMask != retVal->get_object_type()))
+		{
+			retVal.reset();
+		}
+	}
+	return retVal;
+}
+
+std::shared_ptr<isobus::VTObject> HitTestEngine::find(int x, int y)
+{
+	update_index();
+	return index.find(x, y);
+}
+
+const std::vector<std::uint16_t> &HitTestEngine::get_navigation_order()
+{
+	update_index();
+	return navigationOrder;
+}
+
+std::uint16_t HitTestEngine::get_next_in_navigation_order(std::uint16_t currentObjectID, bool forward)
+{
+	std::uint16_t retVal = isobus::NULL_OBJECT_ID;
+	update_index();
+
+	if (!navigationOrder.empty())
+	{
+		auto current = std::find(navigationOrder.begin(), navigationOrder.end(), currentObjectID);
+
+		if (navigationOrder.end() == current)
+		{
+			retVal = forward ? navigationOrder.front() : navigationOrder.back();
+		}
+		else if (forward)
+		{
+			current++;
+			retVal = (navigationOrder.end() == current) ? navigationOrder.front() : *current;
+		}
+		else
+		{
+			retVal = (navigationOrder.begin() == current) ? navigationOrder.back() : *(current - 1);
+		}
+	}
+	return retVal;
+}
+
+void HitTestEngine::update_index()
+{
+	auto mask = get_displayed_mask();
+	auto maskID = (nullptr != mask) ? mask->get_id() : isobus::NULL_OBJECT_ID;
+
+	if ((!indexValid) || (maskID != indexedMaskID))
+	{
+		index.clear();
+		navigationOrder.clear();
+		add_children(mask, 0, 0);
+		index.finalise();
+		indexedMaskID = maskID;
+		indexValid = true;
+	}
+}
+
+void HitTestEngine::add_children(std::shared_ptr<isobus::VTObject> object, int x, int y)
+{
+	// Objects are added in the order a top down search of the tree would test them
+	if (nullptr != object)
+	{
+		index.add_dependency(object->get_id());
+
+		if (isobus::VirtualTerminalObjectType::ObjectPointer == object->get_object_type())
+		{
+			// The object that is pointed to takes the pointer's place
+			add_child(workingSet->get_object_by_id(std::static_pointer_cast<isobus::ObjectPointer>(object)->get_value()), x, y);
+		}
+		else if ((isobus::VirtualTerminalObjectType::Container != object->get_object_type()) ||
+		         (!std::static_pointer_cast<const isobus::Container>(object)->get_hidden()))
+		{
+			// none of the childs of the hidden containers should send clicked events
+			for (std::uint16_t i = 0; i < object->get_number_children(); i++)
+			{
+				auto child = workingSet->get_object_by_id(object->get_child_id(i));
+
+				if (Layout::SoftKeyMask == layout)
+				{
+					// Soft keys fill the grid from the top of the rightmost column
+					int column = (softKeyColumns - 1) - (i / softKeyRows);
+					int row = i % softKeyRows;
+					add_child(child,
+					          x + SoftKeyMaskDimensions::PADDING + column * (softKeyWidth + SoftKeyMaskDimensions::PADDING),
+					          y + SoftKeyMaskDimensions::PADDING + row * (softKeyHeight + SoftKeyMaskDimensions::PADDING));
+				}
+				else
+				{
+					add_child(child, x + object->get_child_x(i), y + object->get_child_y(i));
+				}
+			}
+		}
+	}
+}
+
+void HitTestEngine::add_child(std::shared_ptr<isobus::VTObject> child, int x, int y)
+{
+	// The children of interactive objects are never searched
+	if (is_interactive(child))
+	{
+		if (Layout::SoftKeyMask == layout)
+		{
+			index.add(child, x, y, softKeyWidth, softKeyHeight);
+		}
+		else
+		{
+			index.add(child, x, y, child->get_width(), child->get_height());
+		}
+
+		if (navigationOrder.end() == std::find(navigationOrder.begin(), navigationOrder.end(), child->get_id()))
+		{
+			navigationOrder.push_back(child->get_id());
+		}
+	}
+	else
+	{
+		add_children(child, x, y);
+	}
+}
+
+bool HitTestEngine::is_interactive(std::shared_ptr<isobus::VTObject> object) const
+{
+	bool retVal = false;
+
+	if (nullptr != object)
+	{
+		switch (object->get_object_type())
+		{
+			case isobus::VirtualTerminalObjectType::Key:
+			{
+				retVal = true;
+			}
+			break;
+
+			case isobus::VirtualTerminalObjectType::Button:
+			case isobus::VirtualTerminalObjectType::InputList:
+			case isobus::VirtualTerminalObjectType::InputNumber:
+			case isobus::VirtualTerminalObjectType::InputBoolean:
+			case isobus::VirtualTerminalObjectType::InputString:
+			{
+				retVal = (Layout::DataMask == layout);
+			}
+			break;
+
+			default:
+			{
+				retVal = false;
+			}
+			break;
+		}
+	}
+	return retVal;
+}
@@ -0,0 +1,137 @@
+/*******************************************************************************
+** @file       HitTestIndex.cpp
+** @author     The Open-Agriculture Developers
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "HitTestIndex.hpp"
+
+#include <algorithm>
+#include <limits>
+
+void HitTestIndex::clear()
+{
+	entries.clear();
+	cellStarts.clear();
+	cellEntries.clear();
+	dependencies.clear();
+	columns = 0;
+	rows = 0;
+}
+
+void HitTestIndex::add(std::shared_ptr<isobus::VTObject> object, int x, int y, int width, int height)
+{
+	entries.push_back({ std::move(object), x, y, x + width, y + height });
+}
+
+void HitTestIndex::add_dependency(std::uint16_t objectID)
+{
+	dependencies.insert(objectID);
+}
+
+void HitTestIndex::finalise()
+{
+	cellStarts.clear();
+	cellEntries.clear();
+	columns = 0;
+	rows = 0;
+
+	if (!entries.empty())
+	{
+		int gridRight = std::numeric_limits<int>::min();
+		int gridBottom = std::numeric_limits<int>::min();
+		gridLeft = std::numeric_limits<int>::max();
+		gridTop = std::numeric_limits<int>::max();
+
+		for (const auto &entry : entries)
+		{
+			gridLeft = std::min(gridLeft, entry.left);
+			gridTop = std::min(gridTop, entry.top);
+			gridRight = std::max(gridRight, entry.right);
+			gridBottom = std::max(gridBottom, entry.bottom);
+		}
+
+		auto largestSide = std::max(gridRight - gridLeft, gridBottom - gridTop) + 1;
+		cellSize = std::max(MINIMUM_CELL_SIZE, (largestSide + MAXIMUM_CELLS_PER_SIDE - 1) / MAXIMUM_CELLS_PER_SIDE);
+		columns = ((gridRight - gridLeft) / cellSize) + 1;
+		rows = ((gridBottom - gridTop) / cellSize) + 1;
+
+		// Count the entries in each cell, then fill each cell's range, so every cell is one contiguous run
+		cellStarts.assign(static_cast<std::size_t>(columns * rows) + 1, 0);
+
+		for (const auto &entry : entries)
+		{
+			for (int row = (entry.top - gridTop) / cellSize; row <= (entry.bottom - gridTop) / cellSize; row++)
+			{
+				for (int column = (entry.left - gridLeft) / cellSize; column <= (entry.right - gridLeft) / cellSize; column++)
+				{
+					cellStarts[static_cast<std::size_t>(row * columns + column) + 1]++;
+				}
+			}
+		}
+
+		for (std::size_t i = 1; i < cellStarts.size(); i++)
+		{
+			cellStarts[i] += cellStarts[i - 1];
+		}
+
+		std::vector<std::uint32_t> fillPositions(cellStarts.begin(), cellStarts.end() - 1);
+		cellEntries.resize(cellStarts.back());
+
+		for (std::uint32_t i = 0; i < entries.size(); i++)
+		{
+			const auto &entry = entries[i];
+
+			for (int row = (entry.top - gridTop) / cellSize; row <= (entry.bottom - gridTop) / cellSize; row++)
+			{
+				for (int column = (entry.left - gridLeft) / cellSize; column <= (entry.right - gridLeft) / cellSize; column++)
+				{
+					cellEntries[fillPositions[static_cast<std::size_t>(row * columns + column)]++] = i;
+				}
+			}
+		}
+	}
+}
+
+std::shared_ptr<isobus::VTObject> HitTestIndex::find(int x, int y) const
+{
+	std::shared_ptr<isobus::VTObject> retVal;
+
+	if ((x >= gridLeft) && (y >= gridTop))
+	{
+		auto column = (x - gridLeft) / cellSize;
+		auto row = (y - gridTop) / cellSize;
+
+		if ((column < columns) && (row < rows))
+		{
+			auto cell = static_cast<std::size_t>(row * columns + column);
+
+			// Entries were added to each cell in search order, so the first one that contains the point wins
+			for (auto i = cellStarts[cell]; i < cellStarts[cell + 1]; i++)
+			{
+				const auto &entry = entries[cellEntries[i]];
+
+				if ((x >= entry.left) && (x <= entry.right) && (y >= entry.top) && (y <= entry.bottom))
+				{
+					retVal = entry.object;
+					break;
+				}
+			}
+		}
+	}
+	return retVal;
+}
+
+bool HitTestIndex::depends_on_any(const std::set<std::uint16_t> &objectIDs) const
+{
+	bool retVal = false;
+
+	for (auto objectID : objectIDs)
+	{
+		if (dependencies.end() != dependencies.find(objectID))
+		{
+			retVal = true;
+			break;
+		}
+	}
+	return retVal;
+}
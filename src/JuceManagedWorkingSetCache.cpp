@@ -38,6 +38,23 @@
 #include "WorkingSetComponent.hpp"
 #include "WorkingSetSelectorComponent.hpp"
 
+namespace
+{
+	/// @brief Overwrites the object a component was built from with the current state of that object
+	/// @param[in] component The component to update, which must derive from T
+	/// @param[in] liveObject The object from the working set's object tree
+	template<typename T>
+	void copy_object_state(Component &component, std::shared_ptr<isobus::VTObject> liveObject)
+	{
+		auto componentObject = dynamic_cast<T *>(&component);
+
+		if (nullptr != componentObject)
+		{
+			*componentObject = *std::static_pointer_cast<T>(liveObject);
+		}
+	}
+}
+
 std::vector<JuceManagedWorkingSetCache::ComponentCacheClass> JuceManagedWorkingSetCache::workingSetComponentCache;
 int JuceManagedWorkingSetCache::dataAndAlarmMaskSize = 480;
 SoftKeyMaskDimensions JuceManagedWorkingSetCache::softKeyDimensionInfo = SoftKeyMaskDimensions();
@@ -45,21 +62,8 @@ SoftKeyMaskDimensions JuceManagedWorkingSetCache::softKeyDimensionInfo = SoftKey
 std::shared_ptr<Component> JuceManagedWorkingSetCache::create_component(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::shared_ptr<isobus::VTObject> sourceObject)
 {
 	std::shared_ptr<Component> retVal;
-	bool isWorkingSetKnown = false;
 
-	for (auto &knownWorkingSet : workingSetComponentCache)
-	{
-		if (knownWorkingSet.workingSet == workingSet)
-		{
-			isWorkingSetKnown = true;
-			break;
-		}
-	}
-
-	if (!isWorkingSetKnown)
-	{
-		workingSetComponentCache.emplace_back(workingSet);
-	}
+	get_cache_for_working_set(workingSet);
 
 	if (nullptr != sourceObject)
 	{
@@ -226,11 +230,430 @@ std::shared_ptr<Component> JuceManagedWorkingSetCache::create_component(std::sha
 	if (nullptr != retVal)
 	{
 		retVal->setInterceptsMouseClicks(false, false);
+
+		auto &cache = get_cache_for_working_set(workingSet);
+		register_component(cache.componentLookup[sourceObject->get_id()], retVal.get());
+		register_dependencies(cache, sourceObject, retVal.get());
+	}
+	return retVal;
+}
+
+std::shared_ptr<Component> JuceManagedWorkingSetCache::get_mask_component(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::shared_ptr<isobus::VTObject> maskObject)
+{
+	std::shared_ptr<Component> retVal;
+
+	if (nullptr != maskObject)
+	{
+		auto &cache = get_cache_for_working_set(workingSet);
+		auto cachedMask = cache.maskComponentLookup.find(maskObject->get_id());
+
+		if (cache.maskComponentLookup.end() != cachedMask)
+		{
+			retVal = cachedMask->second;
+		}
+		else
+		{
+			retVal = create_component(workingSet, maskObject);
+
+			if (nullptr != retVal)
+			{
+				get_cache_for_working_set(workingSet).maskComponentLookup[maskObject->get_id()] = retVal;
+			}
+		}
+	}
+	return retVal;
+}
+
+void JuceManagedWorkingSetCache::invalidate(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	for (auto &knownWorkingSet : workingSetComponentCache)
+	{
+		if (knownWorkingSet.workingSet == workingSet)
+		{
+			knownWorkingSet.maskComponentLookup.clear();
+			break;
+		}
+	}
+}
+
+void JuceManagedWorkingSetCache::invalidate(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, const std::set<std::uint16_t> &objectIDs)
+{
+	if (nullptr != workingSet)
+	{
+		auto &cache = get_cache_for_working_set(workingSet);
+		std::set<std::uint16_t> staleMaskIDs;
+		auto workingSetObject = std::static_pointer_cast<isobus::WorkingSet>(workingSet->get_working_set_object());
+
+		if (nullptr != workingSetObject)
+		{
+			auto activeMask = workingSet->get_object_by_id(workingSetObject->get_active_mask());
+			staleMaskIDs.insert(workingSetObject->get_active_mask());
+
+			if ((nullptr != activeMask) && (isobus::VirtualTerminalObjectType::AlarmMask == activeMask->get_object_type()))
+			{
+				staleMaskIDs.insert(std::static_pointer_cast<isobus::AlarmMask>(activeMask)->get_soft_key_mask());
+			}
+			else if ((nullptr != activeMask) && (isobus::VirtualTerminalObjectType::DataMask == activeMask->get_object_type()))
+			{
+				staleMaskIDs.insert(std::static_pointer_cast<isobus::DataMask>(activeMask)->get_soft_key_mask());
+			}
+		}
+
+		// A component belongs to the cached mask it was built under, which is found by walking up its parents
+		std::map<Component *, std::uint16_t> maskIDsByComponent;
+		for (const auto &cachedMask : cache.maskComponentLookup)
+		{
+			maskIDsByComponent[cachedMask.second.get()] = cachedMask.first;
+		}
+
+		for (auto objectID : objectIDs)
+		{
+			auto changedObject = workingSet->get_object_by_id(objectID);
+
+			if ((nullptr != changedObject) && (0 != changedObject->get_number_macros()))
+			{
+				// Macros run by the server in response to a change can modify objects in any mask
+				cache.maskComponentLookup.clear();
+				break;
+			}
+
+			std::vector<Component::SafePointer<Component>> affectedComponents;
+			auto registeredComponents = cache.componentLookup.find(objectID);
+			auto dependentComponents = cache.dependentComponentLookup.find(objectID);
+
+			if (cache.componentLookup.end() != registeredComponents)
+			{
+				affectedComponents = registeredComponents->second;
+			}
+			if (cache.dependentComponentLookup.end() != dependentComponents)
+			{
+				affectedComponents.insert(affectedComponents.end(), dependentComponents->second.begin(), dependentComponents->second.end());
+			}
+
+			for (auto &component : affectedComponents)
+			{
+				for (Component *ancestor = component.getComponent(); nullptr != ancestor; ancestor = ancestor->getParentComponent())
+				{
+					auto owningMask = maskIDsByComponent.find(ancestor);
+
+					if (maskIDsByComponent.end() != owningMask)
+					{
+						staleMaskIDs.insert(owningMask->second);
+						break;
+					}
+				}
+			}
+		}
+
+		for (auto maskID : staleMaskIDs)
+		{
+			cache.maskComponentLookup.erase(maskID);
+		}
+	}
+}
+
+bool JuceManagedWorkingSetCache::update_components(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, const std::set<std::uint16_t> &objectIDs)
+{
+	bool retVal = (nullptr != workingSet);
+
+	// Check everything first so that nothing is left half updated if the masks need to be rebuilt anyways
+	for (auto objectID : objectIDs)
+	{
+		if (!retVal)
+		{
+			break;
+		}
+		retVal = can_update_in_place(workingSet->get_object_by_id(objectID));
+	}
+
+	if (retVal)
+	{
+		auto &cache = get_cache_for_working_set(workingSet);
+
+		for (auto objectID : objectIDs)
+		{
+			auto registeredComponents = cache.componentLookup.find(objectID);
+
+			if (cache.componentLookup.end() != registeredComponents)
+			{
+				auto liveObject = workingSet->get_object_by_id(objectID);
+
+				// Copied, since refreshing an input list builds new components which get registered
+				auto componentsToUpdate = registeredComponents->second;
+				for (auto &component : componentsToUpdate)
+				{
+					if (nullptr != component)
+					{
+						refresh_component(*component, liveObject);
+						component->repaint();
+					}
+				}
+			}
+
+			auto dependentComponents = cache.dependentComponentLookup.find(objectID);
+
+			if (cache.dependentComponentLookup.end() != dependentComponents)
+			{
+				auto componentsToUpdate = dependentComponents->second;
+				for (auto &component : componentsToUpdate)
+				{
+					auto inputList = dynamic_cast<InputListComponent *>(component.getComponent());
+
+					if (nullptr != inputList)
+					{
+						// The selected item may have changed, which means swapping out the child component
+						inputList->onChanged(false);
+					}
+					else if (nullptr != component)
+					{
+						// Dependent components read variables and attributes from the object tree when they paint
+						component->repaint();
+					}
+				}
+			}
+		}
 	}
 	return retVal;
 }
 
+void JuceManagedWorkingSetCache::remove_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	workingSetComponentCache.erase(std::remove_if(workingSetComponentCache.begin(),
+	                                              workingSetComponentCache.end(),
+	                                              [&workingSet](const ComponentCacheClass &cache) { return cache.workingSet == workingSet; }),
+	                               workingSetComponentCache.end());
+}
+
 void JuceManagedWorkingSetCache::set_softkey_mask_dimension_info(const SoftKeyMaskDimensions &info)
 {
 	softKeyDimensionInfo = info;
+
+	// Every cached mask was laid out using the old dimensions
+	for (auto &knownWorkingSet : workingSetComponentCache)
+	{
+		knownWorkingSet.maskComponentLookup.clear();
+	}
+}
+
+void JuceManagedWorkingSetCache::register_component(std::vector<Component::SafePointer<Component>> &registeredComponents, Component *component)
+{
+	// Components from previous builds of the tree are pruned here so that the lookup doesn't grow forever
+	registeredComponents.erase(std::remove_if(registeredComponents.begin(),
+	                                          registeredComponents.end(),
+	                                          [](const Component::SafePointer<Component> &registeredComponent) { return nullptr == registeredComponent.getComponent(); }),
+	                           registeredComponents.end());
+	registeredComponents.emplace_back(component);
+}
+
+void JuceManagedWorkingSetCache::register_dependencies(ComponentCacheClass &cache, std::shared_ptr<isobus::VTObject> sourceObject, Component *component)
+{
+	std::vector<std::uint16_t> referencedObjectIDs;
+
+	switch (sourceObject->get_object_type())
+	{
+		case isobus::VirtualTerminalObjectType::InputBoolean:
+		{
+			auto inputBoolean = std::static_pointer_cast<isobus::InputBoolean>(sourceObject);
+			referencedObjectIDs = { inputBoolean->get_variable_reference(), inputBoolean->get_foreground_colour_object_id() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputString:
+		{
+			auto inputString = std::static_pointer_cast<isobus::InputString>(sourceObject);
+			referencedObjectIDs = { inputString->get_variable_reference(), inputString->get_font_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputNumber:
+		{
+			auto inputNumber = std::static_pointer_cast<isobus::InputNumber>(sourceObject);
+			referencedObjectIDs = { inputNumber->get_variable_reference(), inputNumber->get_font_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputList:
+		{
+			referencedObjectIDs = { std::static_pointer_cast<isobus::InputList>(sourceObject)->get_variable_reference() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputString:
+		{
+			auto outputString = std::static_pointer_cast<isobus::OutputString>(sourceObject);
+			referencedObjectIDs = { outputString->get_variable_reference(), outputString->get_font_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputNumber:
+		{
+			auto outputNumber = std::static_pointer_cast<isobus::OutputNumber>(sourceObject);
+			referencedObjectIDs = { outputNumber->get_variable_reference(), outputNumber->get_font_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputLine:
+		{
+			referencedObjectIDs = { std::static_pointer_cast<isobus::OutputLine>(sourceObject)->get_line_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputRectangle:
+		{
+			auto outputRectangle = std::static_pointer_cast<isobus::OutputRectangle>(sourceObject);
+			referencedObjectIDs = { outputRectangle->get_line_attributes(), outputRectangle->get_fill_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputEllipse:
+		{
+			auto outputEllipse = std::static_pointer_cast<isobus::OutputEllipse>(sourceObject);
+			referencedObjectIDs = { outputEllipse->get_line_attributes(), outputEllipse->get_fill_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputPolygon:
+		{
+			auto outputPolygon = std::static_pointer_cast<isobus::OutputPolygon>(sourceObject);
+			referencedObjectIDs = { outputPolygon->get_line_attributes(), outputPolygon->get_fill_attributes() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputMeter:
+		{
+			referencedObjectIDs = { std::static_pointer_cast<isobus::OutputMeter>(sourceObject)->get_variable_reference() };
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputLinearBarGraph:
+		{
+			referencedObjectIDs = { std::static_pointer_cast<isobus::OutputLinearBarGraph>(sourceObject)->get_variable_reference() };
+		}
+		break;
+
+		default:
+			break;
+	}
+
+	for (auto referencedObjectID : referencedObjectIDs)
+	{
+		if (isobus::NULL_OBJECT_ID != referencedObjectID)
+		{
+			register_component(cache.dependentComponentLookup[referencedObjectID], component);
+		}
+	}
+}
+
+bool JuceManagedWorkingSetCache::can_update_in_place(std::shared_ptr<isobus::VTObject> object)
+{
+	bool retVal = false;
+
+	// Macros run by the server in response to a change can modify other objects without telling us
+	if ((nullptr != object) && (0 == object->get_number_macros()))
+	{
+		switch (object->get_object_type())
+		{
+			case isobus::VirtualTerminalObjectType::InputBoolean:
+			case isobus::VirtualTerminalObjectType::InputString:
+			case isobus::VirtualTerminalObjectType::InputNumber:
+			case isobus::VirtualTerminalObjectType::OutputString:
+			case isobus::VirtualTerminalObjectType::OutputNumber:
+			case isobus::VirtualTerminalObjectType::OutputMeter:
+			case isobus::VirtualTerminalObjectType::OutputLinearBarGraph:
+			case isobus::VirtualTerminalObjectType::InputList:
+			case isobus::VirtualTerminalObjectType::NumberVariable:
+			case isobus::VirtualTerminalObjectType::StringVariable:
+			case isobus::VirtualTerminalObjectType::FontAttributes:
+			case isobus::VirtualTerminalObjectType::LineAttributes:
+			case isobus::VirtualTerminalObjectType::FillAttributes:
+			{
+				retVal = true;
+			}
+			break;
+
+			default:
+			{
+				// Other objects own child components that may need to be moved, created or destroyed
+			}
+			break;
+		}
+	}
+	return retVal;
+}
+
+void JuceManagedWorkingSetCache::refresh_component(Component &component, std::shared_ptr<isobus::VTObject> liveObject)
+{
+	switch (liveObject->get_object_type())
+	{
+		case isobus::VirtualTerminalObjectType::InputBoolean:
+		{
+			copy_object_state<isobus::InputBoolean>(component, liveObject);
+			component.setEnabled(std::static_pointer_cast<isobus::InputBoolean>(liveObject)->get_enabled());
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputString:
+		{
+			copy_object_state<isobus::InputString>(component, liveObject);
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputNumber:
+		{
+			copy_object_state<isobus::InputNumber>(component, liveObject);
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputString:
+		{
+			copy_object_state<isobus::OutputString>(component, liveObject);
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputNumber:
+		{
+			copy_object_state<isobus::OutputNumber>(component, liveObject);
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputMeter:
+		{
+			copy_object_state<isobus::OutputMeter>(component, liveObject);
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::OutputLinearBarGraph:
+		{
+			copy_object_state<isobus::OutputLinearBarGraph>(component, liveObject);
+		}
+		break;
+
+		case isobus::VirtualTerminalObjectType::InputList:
+		{
+			copy_object_state<isobus::InputList>(component, liveObject);
+
+			auto inputList = dynamic_cast<InputListComponent *>(&component);
+			if (nullptr != inputList)
+			{
+				inputList->onChanged(false);
+			}
+		}
+		break;
+
+		default:
+			break;
+	}
+}
+
+JuceManagedWorkingSetCache::ComponentCacheClass &JuceManagedWorkingSetCache::get_cache_for_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	for (auto &knownWorkingSet : workingSetComponentCache)
+	{
+		if (knownWorkingSet.workingSet == workingSet)
+		{
+			return knownWorkingSet;
+		}
+	}
+	workingSetComponentCache.emplace_back(workingSet);
+	return workingSetComponentCache.back();
 }
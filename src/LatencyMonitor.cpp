@@ -0,0 +1,223 @@
+/*******************************************************************************
+** @file       LatencyMonitor.cpp
+** @author     The Open-Agriculture Developers
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "LatencyMonitor.hpp"
+
+#include "ECUToVTCommands.hpp"
+
+#include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const std::map<std::uint8_t, const char *> COMMAND_NAMES = {
+		{ 0xA0, "Hide/Show Object" },
+		{ 0xA1, "Enable/Disable Object" },
+		{ 0xA2, "Select Input Object" },
+		{ 0xA5, "Change Child Location" },
+		{ 0xA6, "Change Size" },
+		{ 0xA7, "Change Background Colour" },
+		{ 0xA8, "Change Numeric Value" },
+		{ 0xA9, "Change End Point" },
+		{ 0xAA, "Change Font Attributes" },
+		{ 0xAB, "Change Line Attributes" },
+		{ 0xAC, "Change Fill Attributes" },
+		{ 0xAD, "Change Active Mask" },
+		{ 0xAE, "Change Soft Key Mask" },
+		{ 0xAF, "Change Attribute" },
+		{ 0xB0, "Change Priority" },
+		{ 0xB1, "Change List Item" },
+		{ 0xB3, "Change String Value" },
+		{ 0xB4, "Change Child Position" },
+		{ 0xB5, "Change Object Label" },
+		{ 0xB6, "Change Polygon Point" },
+		{ 0xB7, "Change Polygon Scale" },
+		{ 0xB8, "Graphics Context" },
+		{ 0xBA, "Select Colour Map" },
+		{ 0xBC, "Execute Extended Macro" },
+		{ 0xBD, "Lock/Unlock Mask" },
+		{ 0xBE, "Execute Macro" }
+	};
+}
+
+LatencyMonitor::~LatencyMonitor()
+{
+	terminate();
+}
+
+void LatencyMonitor::initialize(std::shared_ptr<isobus::InternalControlFunction> serverControlFunction)
+{
+	if (!initialized)
+	{
+		serverInternalControlFunction = serverControlFunction;
+		isobus::CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ECUtoVirtualTerminal), process_rx_message, this);
+		initialized = true;
+	}
+}
+
+void LatencyMonitor::terminate()
+{
+	if (initialized)
+	{
+		isobus::CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ECUtoVirtualTerminal), process_rx_message, this);
+		initialized = false;
+	}
+}
+
+void LatencyMonitor::on_changes_noticed(std::shared_ptr<isobus::ControlFunction> client)
+{
+	const auto now = Time::getMillisecondCounterHiRes();
+	const std::lock_guard<std::mutex> lock(monitorMutex);
+	auto clientCommands = receivedCommands.find(client);
+
+	// Nothing completes noticed commands while the masks aren't painted, such as when the window is
+	// minimised, so the ones that can no longer be recorded are dropped here
+	auto isStale = [now](const PendingCommand &command) { return (now - command.receivedTime_ms) >= STALE_COMMAND_TIMEOUT_MS; };
+	noticedCommands.erase(std::remove_if(noticedCommands.begin(), noticedCommands.end(), isStale), noticedCommands.end());
+
+	if (receivedCommands.end() != clientCommands)
+	{
+		for (auto &command : clientCommands->second)
+		{
+			if ((now - command.receivedTime_ms) < STALE_COMMAND_TIMEOUT_MS)
+			{
+				command.noticedTime_ms = now;
+				noticedCommands.push_back(command);
+			}
+		}
+		receivedCommands.erase(clientCommands);
+	}
+
+	// Under a burst of commands only the most recent are kept
+	if (noticedCommands.size() > MAXIMUM_NOTICED_COMMANDS)
+	{
+		noticedCommands.erase(noticedCommands.begin(), noticedCommands.end() - MAXIMUM_NOTICED_COMMANDS);
+	}
+}
+
+void LatencyMonitor::on_paint_finished()
+{
+	const auto now = Time::getMillisecondCounterHiRes();
+	const std::lock_guard<std::mutex> lock(monitorMutex);
+
+	for (const auto &command : noticedCommands)
+	{
+		if ((now - command.receivedTime_ms) < STALE_COMMAND_TIMEOUT_MS)
+		{
+			auto &commandSamples = samples[command.functionCode];
+			const auto noticed = command.noticedTime_ms - command.receivedTime_ms;
+			const auto painted = now - command.receivedTime_ms;
+
+			if (commandSamples.painted_ms.size() < MAXIMUM_SAMPLES_PER_COMMAND)
+			{
+				commandSamples.noticed_ms.push_back(noticed);
+				commandSamples.painted_ms.push_back(painted);
+			}
+			else
+			{
+				commandSamples.noticed_ms[commandSamples.nextSample] = noticed;
+				commandSamples.painted_ms[commandSamples.nextSample] = painted;
+				commandSamples.nextSample = (commandSamples.nextSample + 1) % MAXIMUM_SAMPLES_PER_COMMAND;
+			}
+		}
+	}
+	noticedCommands.clear();
+}
+
+std::vector<LatencyMonitor::CommandStatistics> LatencyMonitor::get_statistics() const
+{
+	std::vector<CommandStatistics> retVal;
+	const std::lock_guard<std::mutex> lock(monitorMutex);
+
+	for (const auto &commandSamples : samples)
+	{
+		// The percentiles sort the samples, so they work on copies to keep the ring buffer in order
+		auto noticed = commandSamples.second.noticed_ms;
+		auto painted = commandSamples.second.painted_ms;
+		CommandStatistics statistics;
+
+		statistics.functionCode = commandSamples.first;
+		statistics.sampleCount = painted.size();
+		statistics.noticed = get_percentiles(noticed);
+		statistics.painted = get_percentiles(painted);
+		retVal.push_back(statistics);
+	}
+	return retVal;
+}
+
+bool LatencyMonitor::write_csv(const File &file) const
+{
+	String csv = "Command,Function Code,Samples,Noticed P50 (ms),Noticed P95 (ms),Noticed P99 (ms),Painted P50 (ms),Painted P95 (ms),Painted P99 (ms)\n";
+
+	for (const auto &statistics : get_statistics())
+	{
+		csv << get_command_name(statistics.functionCode) << ","
+		    << "0x" << String::toHexString(statistics.functionCode).toUpperCase() << ","
+		    << String(statistics.sampleCount) << ","
+		    << String(statistics.noticed.p50, 2) << ","
+		    << String(statistics.noticed.p95, 2) << ","
+		    << String(statistics.noticed.p99, 2) << ","
+		    << String(statistics.painted.p50, 2) << ","
+		    << String(statistics.painted.p95, 2) << ","
+		    << String(statistics.painted.p99, 2) << "\n";
+	}
+	return file.replaceWithText(csv);
+}
+
+String LatencyMonitor::get_command_name(std::uint8_t functionCode)
+{
+	auto name = COMMAND_NAMES.find(functionCode);
+	return (COMMAND_NAMES.end() != name) ? String(name->second) : ("Command 0x" + String::toHexString(functionCode).toUpperCase());
+}
+
+void LatencyMonitor::process_rx_message(const isobus::CANMessage &message, void *parentPointer)
+{
+	auto monitor = static_cast<LatencyMonitor *>(parentPointer);
+
+	if ((nullptr != monitor) &&
+	    (nullptr != message.get_source_control_function()) &&
+	    (message.get_destination_control_function() == monitor->serverInternalControlFunction) &&
+	    (message.get_data_length() >= 1))
+	{
+		const std::uint8_t functionCode = message.get_uint8_at(0);
+
+		// Mask and input selection changes are timed too, though they don't go through the change tracker
+		if (ECUToVTCommands::can_change_drawing(functionCode))
+		{
+			const std::lock_guard<std::mutex> lock(monitor->monitorMutex);
+			auto &clientCommands = monitor->receivedCommands[message.get_source_control_function()];
+
+			// A client that isn't shown is never noticed, so only its most recent commands are kept
+			if (clientCommands.size() >= MAXIMUM_PENDING_COMMANDS)
+			{
+				clientCommands.pop_front();
+			}
+			clientCommands.push_back({ Time::getMillisecondCounterHiRes(), 0.0, functionCode });
+		}
+	}
+}
+
+LatencyMonitor::Percentiles LatencyMonitor::get_percentiles(std::vector<double> &values)
+{
+	Percentiles retVal;
+
+	if (!values.empty())
+	{
+		// Nearest rank, so every percentile is a latency that was actually measured
+		auto rank = [&values](double percentile) {
+			auto index = static_cast<std::size_t>(std::ceil(percentile * values.size()));
+			return values[std::min(values.size(), std::max<std::size_t>(index, 1)) - 1];
+		};
+
+		std::sort(values.begin(), values.end());
+		retVal.p50 = rank(0.50);
+		retVal.p95 = rank(0.95);
+		retVal.p99 = rank(0.99);
+	}
+	return retVal;
+}
@@ -12,10 +12,13 @@
 
 #include "Main.hpp"
 
+#include <algorithm>
+
 LoggerComponent::LoggerComponent() :
   FileLogger(File(ServerMainComponent::getAppDataDir() + "/AgISOVirtualTerminalLog.txt"),
              "Starting " + AgISOVirtualTerminalApplication::getApplicationNameWithBuildInfo(),
-             1024000)
+             1024000),
+  writerThread(*this)
 {
 	auto bounds = getLocalBounds();
 	setBounds(10, 10, bounds.getWidth() - 10, bounds.getHeight() - 10);
@@ -23,16 +26,30 @@ LoggerComponent::LoggerComponent() :
 	startPos = getLogFile().getSize();
 }
 
+LoggerComponent::~LoggerComponent()
+{
+	writerThread.stopThread(1000);
+}
+
 void LoggerComponent::paint(Graphics &g)
 {
 	g.fillAll(Colours::black);
-	g.setFont(14.0f);
 
-	int numberOfLinesFitted = getHeight() / 14;
+	// Only the rows the viewport shows are drawn, however many lines are kept
+	auto visibleArea = g.getClipBounds();
+	auto viewport = findParentComponentOfClass<Viewport>();
+
+	if (nullptr != viewport)
+	{
+		visibleArea = visibleArea.getIntersection(viewport->getViewArea());
+	}
+
+	int firstLine = std::max(0, visibleArea.getY() / LINE_HEIGHT);
+	int lastLine = std::min(static_cast<int>(loggedMessages.size()) - 1, visibleArea.getBottom() / LINE_HEIGHT);
 
-	for (std::size_t i = 0; i < static_cast<int>(loggedMessages.size()) && i < numberOfLinesFitted; i++)
+	for (int i = firstLine; i <= lastLine; i++)
 	{
-		const auto &message = loggedMessages.at(i);
+		auto &message = loggedMessages.at(static_cast<std::size_t>(i));
 
 		switch (message.logLevel)
 		{
@@ -67,34 +84,234 @@ void LoggerComponent::paint(Graphics &g)
 			}
 			break;
 		}
-		g.drawFittedText(message.logText, 0, static_cast<int>(i) * 14, getWidth(), 14, Justification::centredLeft, 1);
+
+		// Lines are laid out once at the top of the component and moved into place, so new lines pushing them down don't lay them out again
+		if (nullptr == message.glyphs)
+		{
+			message.glyphs = std::make_unique<GlyphArrangement>();
+			message.glyphs->addFittedText(logFont, message.logText, 0.0f, 0.0f, static_cast<float>(getWidth()), static_cast<float>(LINE_HEIGHT), Justification::centredLeft, 1);
+		}
+		message.glyphs->draw(g, AffineTransform::translation(0.0f, static_cast<float>(i * LINE_HEIGHT)));
+	}
+}
+
+void LoggerComponent::resized()
+{
+	// The fitted text depends on the width, but not on the height that grows with each batch
+	if (getWidth() != laidOutWidth)
+	{
+		laidOutWidth = getWidth();
+
+		for (auto &message : loggedMessages)
+		{
+			message.glyphs.reset();
+		}
 	}
 }
 
 void LoggerComponent::sink_CAN_stack_log(LoggingLevel level, const std::string &logText)
 {
-	const auto mmLock = MessageManagerLock();
-	auto bounds = getLocalBounds();
+	// The stack only calls this for lines at or above its log level, so everything here is kept.
+	// The line is copied into fixed size records, so nothing is allocated on the logging thread.
+	const std::uint32_t lineID = nextLineID++;
+	std::size_t position = 0;
+	bool pushed = true;
 
-	loggedMessages.push_front({ logText, level });
+	do
+	{
+		LogRecord record;
+		record.length = std::min(logText.size() - position, record.text.size());
+		record.lineID = lineID;
+		record.continued = ((position + record.length) < logText.size());
+		record.logLevel = level;
+		std::copy_n(logText.begin() + static_cast<std::ptrdiff_t>(position), record.length, record.text.begin());
+		position += record.length;
+		pushed = pendingMessages.push(std::move(record));
+	} while (pushed && (position < logText.size()));
 
-	if (loggedMessages.size() > MAX_NUMBER_MESSAGES)
+	if (!pushed)
 	{
-		loggedMessages.pop_back();
+		droppedMessageCount++;
 	}
 
-	int newSize = static_cast<int>(loggedMessages.size()) * 14;
-
-	if (newSize < getHeight())
+	if (writerWaitingForMessages.exchange(false))
 	{
-		newSize = getHeight();
+		writerThread.notify();
 	}
-	setSize(bounds.getWidth(), newSize);
-	repaint();
-	logMessage(logText);
 }
 
 std::uint64_t LoggerComponent::initialPos() const
 {
 	return startPos;
 }
+
+void LoggerComponent::flush_log_file()
+{
+	write_pending_messages();
+}
+
+void LoggerComponent::timerCallback()
+{
+	stopTimer();
+	show_unshown_messages();
+}
+
+void LoggerComponent::handleAsyncUpdate()
+{
+	// New lines are pulled at most every DISPLAY_INTERVAL_MS, so a burst of logging is shown in one repaint
+	if (!isTimerRunning())
+	{
+		const std::uint32_t elapsed_ms = Time::getMillisecondCounter() - lastDisplayTime_ms;
+
+		if (elapsed_ms >= DISPLAY_INTERVAL_MS)
+		{
+			show_unshown_messages();
+		}
+		else
+		{
+			startTimer(static_cast<int>(DISPLAY_INTERVAL_MS - elapsed_ms));
+		}
+	}
+}
+
+void LoggerComponent::show_unshown_messages()
+{
+	std::vector<LogData> newMessages;
+
+	lastDisplayTime_ms = Time::getMillisecondCounter();
+
+	{
+		const std::lock_guard<std::mutex> lock(unshownMutex);
+		newMessages.swap(unshownMessages);
+	}
+
+	if (!newMessages.empty())
+	{
+		auto bounds = getLocalBounds();
+
+		for (auto &message : newMessages)
+		{
+			loggedMessages.push_front(std::move(message));
+		}
+
+		while (loggedMessages.size() > MAX_NUMBER_MESSAGES)
+		{
+			loggedMessages.pop_back();
+		}
+
+		int newSize = static_cast<int>(loggedMessages.size()) * LINE_HEIGHT;
+
+		if (newSize < getHeight())
+		{
+			newSize = getHeight();
+		}
+		setSize(bounds.getWidth(), newSize);
+		repaint();
+	}
+}
+
+void LoggerComponent::write_pending_messages()
+{
+	const std::lock_guard<std::mutex> writeLock(writeMutex);
+	std::vector<LogData> batch;
+	LogRecord record;
+
+	while (pendingMessages.pop(record))
+	{
+		auto partialLine = partialLines.find(record.lineID);
+
+		if ((partialLines.end() == partialLine) && (!record.continued))
+		{
+			batch.push_back({ std::string(record.text.data(), record.length), record.logLevel });
+		}
+		else
+		{
+			auto &line = partialLines[record.lineID];
+			line.logText.append(record.text.data(), record.length);
+			line.logLevel = record.logLevel;
+
+			if (!record.continued)
+			{
+				batch.push_back(std::move(line));
+				partialLines.erase(record.lineID);
+			}
+		}
+	}
+
+	auto droppedCount = droppedMessageCount.exchange(0);
+
+	if (0 != droppedCount)
+	{
+		// The rest of a line may be what was dropped, in which case it would never be finished
+		for (auto &line : partialLines)
+		{
+			line.second.logText += "...";
+			batch.push_back(std::move(line.second));
+		}
+		partialLines.clear();
+		batch.push_back({ "[Logger]: " + std::to_string(droppedCount) + " log lines were dropped because logging fell behind", LoggingLevel::Warning });
+	}
+
+	if (!batch.empty())
+	{
+		StringArray lines;
+
+		for (const auto &line : batch)
+		{
+			lines.add(line.logText);
+		}
+		logMessage(lines.joinIntoString(newLine.getDefault()));
+
+		const std::lock_guard<std::mutex> unshownLock(unshownMutex);
+		unshownMessages.insert(unshownMessages.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+
+		// Lines beyond what the component keeps would be dropped as soon as they were pulled
+		if (unshownMessages.size() > MAX_NUMBER_MESSAGES)
+		{
+			unshownMessages.erase(unshownMessages.begin(), unshownMessages.end() - MAX_NUMBER_MESSAGES);
+		}
+		triggerAsyncUpdate();
+	}
+}
+
+bool LoggerComponent::has_pending_messages()
+{
+	const std::lock_guard<std::mutex> writeLock(writeMutex);
+	return !pendingMessages.is_empty();
+}
+
+LoggerComponent::LogWriterThread::LogWriterThread(LoggerComponent &parentLogger) :
+  Thread("Log Writer"),
+  logger(parentLogger)
+{
+	startThread();
+}
+
+LoggerComponent::LogWriterThread::~LogWriterThread()
+{
+	stopThread(1000);
+}
+
+void LoggerComponent::LogWriterThread::run()
+{
+	while (!threadShouldExit())
+	{
+		logger.write_pending_messages();
+
+		// The flag is set before the buffer is checked, so a line logged in between still wakes the thread
+		logger.writerWaitingForMessages = true;
+
+		if (!logger.has_pending_messages())
+		{
+			wait(-1);
+		}
+		logger.writerWaitingForMessages = false;
+
+		// Lines are collected for a while after waking, so a burst of logging is written in one go
+		if (!threadShouldExit())
+		{
+			wait(WRITE_INTERVAL_MS);
+		}
+	}
+	logger.write_pending_messages();
+}
@@ -9,13 +9,11 @@
 #include "Settings.hpp"
 #include "git.h"
 
-AgISOVirtualTerminalApplication::MainWindow::MainWindow(juce::String name,
-                                                        const std::string &canLogPath,
-                                                        int vtNumberCmdLineArg,
-                                                        std::string screenCaptureDir) :
-  DocumentWindow(name,
-                 juce::Desktop::getInstance().getDefaultLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId),
-                 DocumentWindow::allButtons)
+ServerMainComponent *AgISOVirtualTerminalApplication::create_server(std::vector<std::shared_ptr<isobus::CANHardwarePlugin>> &canDrivers,
+                                                                     std::shared_ptr<isobus::InternalControlFunction> &serverInternalControlFunction,
+                                                                     const std::string &canLogPath,
+                                                                     int vtNumberCmdLineArg,
+                                                                     std::string screenCaptureDir)
 {
 	int vtNumber = vtNumberCmdLineArg;
 #ifdef JUCE_WINDOWS
@@ -78,8 +76,19 @@ AgISOVirtualTerminalApplication::MainWindow::MainWindow(juce::String name,
 	serverNAME.set_industry_group(2);
 	serverNAME.set_manufacturer_code(1407);
 	serverInternalControlFunction = isobus::CANNetworkManager::CANNetwork.create_internal_control_function(serverNAME, 0, 0x26);
+	return new ServerMainComponent(serverInternalControlFunction, canDrivers, settings.settingsValueTree(), canLogPath, vtNumber, screenCaptureDir);
+}
+
+AgISOVirtualTerminalApplication::MainWindow::MainWindow(juce::String name,
+                                                        const std::string &canLogPath,
+                                                        int vtNumberCmdLineArg,
+                                                        std::string screenCaptureDir) :
+  DocumentWindow(name,
+                 juce::Desktop::getInstance().getDefaultLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId),
+                 DocumentWindow::allButtons)
+{
 	setUsingNativeTitleBar(true);
-	setContentOwned(new ServerMainComponent(serverInternalControlFunction, canDrivers, settings.settingsValueTree(), canLogPath, vtNumber, screenCaptureDir), true);
+	setContentOwned(create_server(canDrivers, serverInternalControlFunction, canLogPath, vtNumberCmdLineArg, screenCaptureDir), true);
 
 #if JUCE_IOS || JUCE_ANDROID
 	setFullScreen(true);
@@ -109,6 +118,23 @@ void AgISOVirtualTerminalApplication::MainWindow::closeButtonPressed()
 	JUCEApplication::getInstance()->systemRequestedQuit();
 }
 
+AgISOVirtualTerminalApplication::HeadlessServer::HeadlessServer(const std::string &canLogPath,
+                                                                int vtNumberCmdLineArg,
+                                                                std::string screenCaptureDir)
+{
+	server.reset(create_server(canDrivers, serverInternalControlFunction, canLogPath, vtNumberCmdLineArg, screenCaptureDir));
+
+	// There is nobody to select "Start/Stop", so always run the CAN interface
+	server->start_can_interface();
+	isobus::CANStackLogger::info("Running headless. Masks will only be rendered for screen captures.");
+}
+
+AgISOVirtualTerminalApplication::HeadlessServer::~HeadlessServer()
+{
+	isobus::CANHardwareInterface::stop();
+	server.reset();
+}
+
 std::string AgISOVirtualTerminalApplication::getApplicationBuildInfo()
 {
 	std::string gitDescribe = std::string(git::Describe());
@@ -0,0 +1,146 @@
+/*******************************************************************************
+** @file       ObjectChangeTracker.cpp
+** @author     The Open-Agriculture Developers
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "ObjectChangeTracker.hpp"
+
+#include "ECUToVTCommands.hpp"
+
+#include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+
+ObjectChangeTracker::~ObjectChangeTracker()
+{
+	terminate();
+}
+
+void ObjectChangeTracker::initialize(std::shared_ptr<isobus::InternalControlFunction> serverControlFunction)
+{
+	if (!initialized)
+	{
+		serverInternalControlFunction = serverControlFunction;
+		isobus::CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ECUtoVirtualTerminal), process_rx_message, this);
+		initialized = true;
+	}
+}
+
+void ObjectChangeTracker::terminate()
+{
+	if (initialized)
+	{
+		isobus::CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ECUtoVirtualTerminal), process_rx_message, this);
+		initialized = false;
+	}
+}
+
+ObjectChangeTracker::Changes ObjectChangeTracker::take_changes(std::shared_ptr<isobus::ControlFunction> client)
+{
+	Changes retVal;
+	std::lock_guard<std::mutex> lock(changesMutex);
+	auto clientChanges = pendingChanges.find(client);
+
+	if (pendingChanges.end() != clientChanges)
+	{
+		retVal = std::move(clientChanges->second);
+		pendingChanges.erase(clientChanges);
+	}
+	return retVal;
+}
+
+void ObjectChangeTracker::clear_changes(std::shared_ptr<isobus::ControlFunction> client)
+{
+	std::lock_guard<std::mutex> lock(changesMutex);
+	pendingChanges.erase(client);
+}
+
+void ObjectChangeTracker::process_rx_message(const isobus::CANMessage &message, void *parentPointer)
+{
+	auto tracker = static_cast<ObjectChangeTracker *>(parentPointer);
+
+	if ((nullptr != tracker) &&
+	    (nullptr != message.get_source_control_function()) &&
+	    (message.get_destination_control_function() == tracker->serverInternalControlFunction) &&
+	    (message.get_data_length() >= 3))
+	{
+		const std::uint8_t functionCode = message.get_uint8_at(0);
+
+		if (ECUToVTCommands::changes_objects(functionCode))
+		{
+			std::lock_guard<std::mutex> lock(tracker->changesMutex);
+			auto &changes = tracker->pendingChanges[message.get_source_control_function()];
+			changes.hasCommands = true;
+
+			switch (functionCode)
+			{
+				case ECUToVTCommands::ENABLE_DISABLE_OBJECT_COMMAND:
+				case ECUToVTCommands::CHANGE_NUMERIC_VALUE_COMMAND:
+				case ECUToVTCommands::CHANGE_FONT_ATTRIBUTES_COMMAND:
+				case ECUToVTCommands::CHANGE_LINE_ATTRIBUTES_COMMAND:
+				case ECUToVTCommands::CHANGE_FILL_ATTRIBUTES_COMMAND:
+				case ECUToVTCommands::CHANGE_STRING_VALUE_COMMAND:
+				{
+					changes.objectIDs.insert(message.get_uint16_at(1));
+				}
+				break;
+
+				case ECUToVTCommands::SELECT_COLOUR_MAP_OR_PALETTE_COMMAND:
+				{
+					changes.paletteChanged = true;
+					changes.requiresFullRebuild = true;
+				}
+				break;
+
+				case ECUToVTCommands::HIDE_SHOW_OBJECT_COMMAND:
+				case ECUToVTCommands::CHANGE_SIZE_COMMAND:
+				case ECUToVTCommands::CHANGE_BACKGROUND_COLOUR_COMMAND:
+				case ECUToVTCommands::CHANGE_END_POINT_COMMAND:
+				case ECUToVTCommands::CHANGE_ATTRIBUTE_COMMAND:
+				case ECUToVTCommands::CHANGE_PRIORITY_COMMAND:
+				case ECUToVTCommands::CHANGE_LIST_ITEM_COMMAND:
+				case ECUToVTCommands::CHANGE_OBJECT_LABEL_COMMAND:
+				case ECUToVTCommands::CHANGE_POLYGON_POINT_COMMAND:
+				case ECUToVTCommands::CHANGE_POLYGON_SCALE_COMMAND:
+				case ECUToVTCommands::GRAPHICS_CONTEXT_COMMAND:
+				{
+					// These can move, resize, or hide things, so the masks that draw the object are rebuilt
+					changes.objectIDs.insert(message.get_uint16_at(1));
+					changes.requiresFullRebuild = true;
+				}
+				break;
+
+				case ECUToVTCommands::CHANGE_CHILD_LOCATION_COMMAND:
+				case ECUToVTCommands::CHANGE_CHILD_POSITION_COMMAND:
+				{
+					// The parent is what has to be laid out again
+					changes.objectIDs.insert(message.get_uint16_at(1));
+					if (message.get_data_length() >= 5)
+					{
+						changes.objectIDs.insert(message.get_uint16_at(3));
+					}
+					changes.requiresFullRebuild = true;
+				}
+				break;
+
+				case ECUToVTCommands::CHANGE_SOFT_KEY_MASK_COMMAND:
+				{
+					// Names the data or alarm mask whose soft key mask was swapped
+					if (message.get_data_length() >= 4)
+					{
+						changes.objectIDs.insert(message.get_uint16_at(2));
+					}
+					changes.requiresFullRebuild = true;
+				}
+				break;
+
+				default:
+				{
+					// Things like macros can affect any part of any mask
+					changes.requiresFullRebuild = true;
+					changes.changedUnknownObjects = true;
+				}
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,877 @@
+/*******************************************************************************
+** @file       ObjectPoolStorage.cpp
+** @author     The Open-Agriculture Developers
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "ObjectPoolStorage.hpp"
+
+#include "isobus/isobus/can_stack_logger.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#ifndef JUCE_WINDOWS
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	/// @brief Returns the number at the end of a pool file's name, like the 3 in object_pool_3.iop
+	int get_file_index(const File &file)
+	{
+		return file.getFileNameWithoutExtension().fromLastOccurrenceOf("_", false, false).getIntValue();
+	}
+}
+
+ObjectPoolStorage::ObjectPoolStorage(const File &storageDirectory, bool openReadOnly) :
+  directory(storageDirectory),
+  chunkDirectory(storageDirectory.getChildFile(CHUNK_DIRECTORY_NAME)),
+  readOnly(openReadOnly)
+{
+	auto clientDirectories = directory.findChildFiles(File::findDirectories, false, "*");
+
+	for (const auto &clientDirectory : clientDirectories)
+	{
+		if (clientDirectory.getFileName().containsOnly("0123456789abcdefABCDEF"))
+		{
+			get_manifest(isobus::NAME(static_cast<std::uint64_t>(clientDirectory.getFileName().getHexValue64())));
+		}
+	}
+
+	StringArray unreferencedChunks;
+
+	for (const auto &chunkFile : chunkDirectory.findChildFiles(File::findFiles, false, String("*") + CHUNK_FILE_EXTENSION + ";*" + COMPRESSED_CHUNK_FILE_EXTENSION))
+	{
+		knownChunks[chunkFile.getFileNameWithoutExtension()] = chunkFile.hasFileExtension(COMPRESSED_CHUNK_FILE_EXTENSION);
+		unreferencedChunks.add(chunkFile.getFileNameWithoutExtension());
+	}
+
+	// Chunks can be left behind if the server stopped part way through saving a pool
+	if (chunkRemovalDisabled)
+	{
+		isobus::CANStackLogger::warn("[VT Server]: Saved object pool chunks will not be cleaned up, because a manifest could not be read");
+	}
+	else if (!readOnly)
+	{
+		remove_unreferenced_chunks(unreferencedChunks);
+	}
+}
+
+std::vector<isobus::NAME> ObjectPoolStorage::get_clients()
+{
+	const std::lock_guard<std::mutex> lock(indexMutex);
+	std::vector<isobus::NAME> retVal;
+
+	for (const auto &manifest : manifests)
+	{
+		if (!manifest.second.parts.empty())
+		{
+			retVal.emplace_back(manifest.first);
+		}
+	}
+	return retVal;
+}
+
+std::vector<ObjectPoolStorage::VersionLabel> ObjectPoolStorage::get_versions(isobus::NAME clientNAME)
+{
+	std::vector<VersionLabel> retVal;
+
+	{
+		// Answered from the manifest in memory, so this never waits on a save's file writes
+		const std::lock_guard<std::mutex> lock(indexMutex);
+
+		for (const auto &part : get_manifest(clientNAME).parts)
+		{
+			// Only add the version label if it is not already in the list
+			if (retVal.end() == std::find(retVal.begin(), retVal.end(), part.label))
+			{
+				retVal.push_back(part.label);
+			}
+		}
+	}
+
+	if (retVal.empty())
+	{
+		isobus::CANStackLogger::info("[VT Server]: No saved object pool data for client: " + get_client_directory(clientNAME).getFileName().toStdString());
+	}
+	return retVal;
+}
+
+std::vector<std::uint8_t> ObjectPoolStorage::load_version(const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME)
+{
+	std::vector<std::uint8_t> retVal;
+	std::vector<StoredPart> versionParts;
+	auto clientDirectory = get_client_directory(clientNAME);
+	std::int64_t totalSize = 0;
+
+	// The files are read without the index locked, and only files being deleted can hold up the read
+	const std::shared_lock<std::shared_mutex> fileLock(fileRemovalMutex);
+
+	{
+		const std::lock_guard<std::mutex> lock(indexMutex);
+
+		for (const auto &part : get_manifest(clientNAME).parts)
+		{
+			if (labels_match(part.label, versionLabel))
+			{
+				versionParts.push_back(part);
+				totalSize += part.size;
+			}
+		}
+	}
+
+	// The manifest knows the size of every part, so each part is read straight into its place in one buffer
+	retVal.resize(static_cast<std::size_t>(totalSize));
+	std::size_t offset = 0;
+
+	for (const auto &part : versionParts)
+	{
+		if (!read_part(clientDirectory, part, retVal.data() + offset))
+		{
+			// Better to have the client upload its pool again than to parse damaged data
+			isobus::CANStackLogger::error("[VT Server]: Saved object pool version " + String::toHexString(part.label.data(), static_cast<int>(part.label.size()), 0).toStdString() + " of client " + clientDirectory.getFileName().toStdString() + " is damaged and will not be loaded");
+			retVal.clear();
+			break;
+		}
+		offset += static_cast<std::size_t>(part.size);
+	}
+	return retVal;
+}
+
+bool ObjectPoolStorage::save_version(const std::vector<std::uint8_t> &objectPool,
+                                     const std::vector<std::uint8_t> &versionLabel,
+                                     isobus::NAME clientNAME,
+                                     std::size_t expectedPartCount,
+                                     std::uint32_t requestTime)
+{
+	const std::lock_guard<std::mutex> writeLock(writeMutex);
+	bool retVal = false;
+	auto &manifest = get_locked_manifest(clientNAME);
+
+	if ((!readOnly) && (VERSION_LABEL_LENGTH == versionLabel.size()))
+	{
+		StoredPart newPart;
+		std::copy(versionLabel.begin(), versionLabel.end(), newPart.label.begin());
+		newPart.size = static_cast<std::int64_t>(objectPool.size());
+		newPart.checksum = calculate_checksum(objectPool.data(), objectPool.size());
+
+		bool continuesStore = manifest.store.active &&
+		  (manifest.store.label == newPart.label) &&
+		  (manifest.store.expectedPartCount == expectedPartCount);
+
+		if (0 != expectedPartCount)
+		{
+			// Saving a part can take longer than the timeout, so a known part count is all that groups the parts
+			continuesStore = continuesStore && (manifest.store.partsReceived < expectedPartCount);
+		}
+		else
+		{
+			// The request may have been queued while the previous part was still being saved, which is still in time
+			continuesStore = continuesStore &&
+			  (static_cast<std::int32_t>(requestTime - manifest.store.lastPartTime) <= static_cast<std::int32_t>(STORE_SEQUENCE_TIMEOUT_MS));
+		}
+
+		if (!continuesStore)
+		{
+			finish_store(clientNAME, manifest);
+			manifest.store = StoreSequence();
+			manifest.store.label = newPart.label;
+			manifest.store.expectedPartCount = expectedPartCount;
+			manifest.store.active = true;
+
+			for (const auto &part : manifest.parts)
+			{
+				if (part.label == newPart.label)
+				{
+					manifest.store.replacedParts.push_back(part);
+				}
+			}
+		}
+
+		// Chunks that are already stored aren't written again, so an unchanged part costs no writes at all
+		if (store_chunks(objectPool.data(), objectPool.size(), newPart.chunks))
+		{
+			manifest.store.parts.push_back(newPart);
+			retVal = true;
+		}
+		else
+		{
+			manifest.store.failed = true;
+		}
+		manifest.store.partsReceived++;
+
+		if (0 == manifest.store.expectedPartCount)
+		{
+			// Without a part count the last part can't be recognised, so the version is stored as it is so far
+			// before the part is answered. What it replaces is kept in case a later part fails.
+			retVal = retVal &&
+			  (!manifest.store.failed) &&
+			  commit_parts(clientNAME, manifest, manifest.store.label, manifest.store.parts);
+			manifest.store.failed = !retVal;
+		}
+		else if (manifest.store.partsReceived >= manifest.store.expectedPartCount)
+		{
+			retVal = finish_store(clientNAME, manifest) && retVal;
+		}
+
+		// Timed from when the part finished saving rather than when it was requested, since the
+		// next part is only requested once this one has been answered
+		manifest.store.lastPartTime = Time::getMillisecondCounter();
+	}
+	return retVal;
+}
+
+bool ObjectPoolStorage::delete_version(const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME)
+{
+	const std::lock_guard<std::mutex> writeLock(writeMutex);
+	auto &manifest = get_locked_manifest(clientNAME);
+	finish_store(clientNAME, manifest);
+	return (!readOnly) && remove_parts(clientNAME, manifest, [&versionLabel](const StoredPart &part) { return labels_match(part.label, versionLabel); });
+}
+
+bool ObjectPoolStorage::delete_all_versions(isobus::NAME clientNAME)
+{
+	const std::lock_guard<std::mutex> writeLock(writeMutex);
+	auto &manifest = get_locked_manifest(clientNAME);
+	finish_store(clientNAME, manifest);
+	return (!readOnly) && remove_parts(clientNAME, manifest, [](const StoredPart &) { return true; });
+}
+
+void ObjectPoolStorage::set_compression_enabled(bool enabled)
+{
+	compressionEnabled = enabled;
+}
+
+bool ObjectPoolStorage::clear()
+{
+	const std::lock_guard<std::mutex> writeLock(writeMutex);
+	bool retVal = false;
+
+	if (!readOnly)
+	{
+		// Everything is deleted, so unlike other writes this keeps readers waiting until it is done
+		const std::unique_lock<std::shared_mutex> fileLock(fileRemovalMutex);
+		const std::lock_guard<std::mutex> lock(indexMutex);
+
+		manifests.clear();
+		knownChunks.clear();
+		chunkRemovalDisabled = false;
+		retVal = directory.isDirectory() && directory.deleteRecursively();
+	}
+	return retVal;
+}
+
+bool ObjectPoolStorage::add_to_package(ZipFile::Builder &packageBuilder, const std::function<bool(const String &)> &includeClient)
+{
+	bool retVal = false;
+	std::map<std::uint64_t, std::vector<StoredPart>> clientParts;
+	const std::shared_lock<std::shared_mutex> fileLock(fileRemovalMutex);
+
+	{
+		const std::lock_guard<std::mutex> lock(indexMutex);
+
+		for (const auto &manifest : manifests)
+		{
+			clientParts[manifest.first] = manifest.second.parts;
+		}
+	}
+
+	for (const auto &parts : clientParts)
+	{
+		auto clientDirectory = get_client_directory(isobus::NAME(parts.first));
+
+		if (includeClient(clientDirectory.getFileName()))
+		{
+			int partNumber = 0;
+
+			for (const auto &part : parts.second)
+			{
+				MemoryBlock partData(static_cast<std::size_t>(part.size));
+
+				if (read_part(clientDirectory, part, static_cast<std::uint8_t *>(partData.getData())))
+				{
+					packageBuilder.addEntry(new MemoryInputStream(std::move(partData)), 9, "iso_data/" + clientDirectory.getFileName() + "/object_pool_" + String(partNumber) + ".iop", Time::getCurrentTime());
+					retVal = true;
+				}
+				partNumber++;
+			}
+		}
+	}
+	return retVal;
+}
+
+bool ObjectPoolStorage::StoredPart::has_same_contents(const StoredPart &other) const
+{
+	// Chunk hashes identify the data, but parts in the old .iopx files only have a checksum
+	return fileName.isEmpty() &&
+	  other.fileName.isEmpty() &&
+	  (size == other.size) &&
+	  (checksum == other.checksum) &&
+	  (chunks == other.chunks);
+}
+
+File ObjectPoolStorage::get_client_directory(isobus::NAME clientNAME) const
+{
+	std::ostringstream nameString;
+	nameString << std::hex << std::setfill('0') << std::setw(16) << clientNAME.get_full_name();
+	return directory.getChildFile(nameString.str());
+}
+
+File ObjectPoolStorage::get_chunk_file(const String &chunkHash, bool compressed) const
+{
+	return chunkDirectory.getChildFile(chunkHash + (compressed ? COMPRESSED_CHUNK_FILE_EXTENSION : CHUNK_FILE_EXTENSION));
+}
+
+bool ObjectPoolStorage::write_chunk(const String &chunkHash, const std::uint8_t *data, std::size_t length)
+{
+	bool retVal = false;
+	MemoryOutputStream compressedChunk;
+	const bool shouldCompress = compressionEnabled;
+
+	if (shouldCompress)
+	{
+		GZIPCompressorOutputStream compressor(compressedChunk);
+		compressor.write(data, length);
+		compressor.flush();
+	}
+
+	// Data that is already compressed, like some picture graphics, is better stored as it is
+	bool storeCompressed = shouldCompress && (compressedChunk.getDataSize() < length);
+
+	if (chunkDirectory.createDirectory().wasOk())
+	{
+		if (storeCompressed)
+		{
+			retVal = write_file_durably(get_chunk_file(chunkHash, true), compressedChunk.getData(), compressedChunk.getDataSize());
+		}
+		else
+		{
+			retVal = write_file_durably(get_chunk_file(chunkHash, false), data, length);
+		}
+	}
+
+	if (retVal)
+	{
+		const std::lock_guard<std::mutex> lock(indexMutex);
+		knownChunks[chunkHash] = storeCompressed;
+	}
+	return retVal;
+}
+
+ObjectPoolStorage::ClientManifest &ObjectPoolStorage::get_locked_manifest(isobus::NAME clientNAME)
+{
+	const std::lock_guard<std::mutex> lock(indexMutex);
+	return get_manifest(clientNAME);
+}
+
+ObjectPoolStorage::ClientManifest &ObjectPoolStorage::get_manifest(isobus::NAME clientNAME)
+{
+	auto existingManifest = manifests.find(clientNAME.get_full_name());
+
+	if (manifests.end() == existingManifest)
+	{
+		auto clientDirectory = get_client_directory(clientNAME);
+		ClientManifest manifest;
+
+		if (!read_manifest(clientDirectory, manifest))
+		{
+			auto manifestFile = clientDirectory.getChildFile(MANIFEST_FILE_NAME);
+
+			if ((!readOnly) && manifestFile.existsAsFile())
+			{
+				// It may be damaged or from a newer version, so it is set aside rather than replaced
+				auto unreadableManifestFile = clientDirectory.getChildFile(UNREADABLE_MANIFEST_FILE_NAME).getNonexistentSibling();
+				manifestFile.moveFileTo(unreadableManifestFile);
+				isobus::CANStackLogger::error("[VT Server]: The object pool manifest in " + clientDirectory.getFileName().toStdString() + " could not be read and was moved to " + unreadableManifestFile.getFileName().toStdString());
+			}
+			manifest = index_directory(clientDirectory);
+
+			if ((!readOnly) && (!manifest.parts.empty()))
+			{
+				isobus::CANStackLogger::info("[VT Server]: Indexed " + std::to_string(manifest.parts.size()) + " saved object pool files in " + clientDirectory.getFileName().toStdString());
+				write_manifest(clientDirectory, manifest.parts);
+			}
+		}
+
+		// The chunks a set aside manifest refers to are unknown, so none may be deleted while one exists
+		if (!clientDirectory.findChildFiles(File::findFiles, false, UNREADABLE_MANIFEST_WILDCARD).isEmpty())
+		{
+			chunkRemovalDisabled = true;
+		}
+		existingManifest = manifests.emplace(clientNAME.get_full_name(), std::move(manifest)).first;
+	}
+	return existingManifest->second;
+}
+
+bool ObjectPoolStorage::commit_parts(isobus::NAME clientNAME, ClientManifest &manifest, const VersionLabel &label, const std::vector<StoredPart> &parts)
+{
+	bool retVal = true;
+	std::vector<StoredPart> currentParts;
+
+	for (const auto &part : manifest.parts)
+	{
+		if (part.label == label)
+		{
+			currentParts.push_back(part);
+		}
+	}
+
+	bool unchanged = std::equal(currentParts.begin(), currentParts.end(), parts.begin(), parts.end(), [](const StoredPart &first, const StoredPart &second) {
+		return first.has_same_contents(second);
+	});
+
+	if (!unchanged)
+	{
+		auto clientDirectory = get_client_directory(clientNAME);
+		auto committedParts = manifest.parts;
+
+		committedParts.erase(std::remove_if(committedParts.begin(), committedParts.end(), [&label](const StoredPart &part) { return part.label == label; }), committedParts.end());
+		committedParts.insert(committedParts.end(), parts.begin(), parts.end());
+
+		// This one manifest write swaps every part of the version at once
+		retVal = clientDirectory.createDirectory().wasOk() && write_manifest(clientDirectory, committedParts);
+
+		if (retVal)
+		{
+			const std::lock_guard<std::mutex> lock(indexMutex);
+			manifest.parts = std::move(committedParts);
+		}
+	}
+	return retVal;
+}
+
+bool ObjectPoolStorage::finish_store(isobus::NAME clientNAME, ClientManifest &manifest)
+{
+	bool retVal = true;
+
+	if (manifest.store.active)
+	{
+		// Taken out of the manifest first, so its chunks are no longer kept when the store is released
+		auto store = std::move(manifest.store);
+		manifest.store = StoreSequence();
+
+		StringArray stagedChunks;
+
+		for (const auto &part : store.parts)
+		{
+			stagedChunks.addArray(part.chunks);
+		}
+
+		bool complete = (!store.failed) &&
+		  ((0 == store.expectedPartCount) || (store.partsReceived >= store.expectedPartCount));
+
+		if (complete)
+		{
+			// Without a part count, the version was already stored as each part was saved
+			retVal = (0 == store.expectedPartCount) || commit_parts(clientNAME, manifest, store.label, store.parts);
+		}
+		else
+		{
+			isobus::CANStackLogger::warn("[VT Server]: Object pool version " + String::toHexString(store.label.data(), static_cast<int>(store.label.size()), 0).toStdString() + " of client " + get_client_directory(clientNAME).getFileName().toStdString() + " was not stored because not all of its parts were saved");
+			retVal = false;
+		}
+
+		if (retVal)
+		{
+			release_parts(get_client_directory(clientNAME), store.replacedParts);
+		}
+		else
+		{
+			// The previous version stays as it was, or is put back if some of these parts were already stored
+			if (0 == store.expectedPartCount)
+			{
+				commit_parts(clientNAME, manifest, store.label, store.replacedParts);
+			}
+			remove_unreferenced_chunks(stagedChunks);
+		}
+	}
+	return retVal;
+}
+
+bool ObjectPoolStorage::store_chunks(const std::uint8_t *data, std::size_t length, StringArray &chunkHashes)
+{
+	bool retVal = true;
+	bool anyChunksWritten = false;
+
+	for (std::size_t offset = 0; offset < length; offset += CHUNK_SIZE)
+	{
+		auto chunkLength = std::min(CHUNK_SIZE, length - offset);
+		auto chunkHash = SHA256(data + offset, chunkLength).toHexString();
+
+		if (knownChunks.end() == knownChunks.find(chunkHash))
+		{
+			if (!write_chunk(chunkHash, data + offset, chunkLength))
+			{
+				isobus::CANStackLogger::warn("[VT Server]: Failed to write object pool chunk " + chunkHash.toStdString());
+				retVal = false;
+				break;
+			}
+			anyChunksWritten = true;
+		}
+		chunkHashes.add(chunkHash);
+	}
+
+	// One sync of the directory makes every chunk of the part durable, before a manifest can refer to them
+	if (retVal && anyChunksWritten)
+	{
+		retVal = sync_directory(chunkDirectory);
+	}
+	return retVal;
+}
+
+bool ObjectPoolStorage::read_part(const File &clientDirectory, const StoredPart &part, std::uint8_t *destination) const
+{
+	bool retVal = true;
+
+	if (part.fileName.isNotEmpty())
+	{
+		FileInputStream iopxStream(clientDirectory.getChildFile(part.fileName));
+		retVal = iopxStream.openedOk() &&
+		  ((iopxStream.getTotalLength() - static_cast<std::int64_t>(VERSION_LABEL_LENGTH)) == part.size) &&
+		  iopxStream.setPosition(static_cast<std::int64_t>(VERSION_LABEL_LENGTH));
+
+		if (retVal && (part.size > 0))
+		{
+			retVal = (static_cast<std::int64_t>(iopxStream.read(destination, static_cast<int>(part.size))) == part.size);
+		}
+	}
+	else
+	{
+		auto partSize = static_cast<std::size_t>(part.size);
+		std::size_t offset = 0;
+
+		// Every chunk but the last is CHUNK_SIZE long, so where each one goes is known before it is read
+		for (const auto &chunkHash : part.chunks)
+		{
+			auto chunkLength = std::min(CHUNK_SIZE, partSize - offset);
+
+			if ((0 == chunkLength) || (!read_chunk(chunkHash, destination + offset, chunkLength)))
+			{
+				retVal = false;
+				break;
+			}
+			offset += chunkLength;
+		}
+		retVal = retVal && (offset == partSize);
+	}
+	return retVal && (calculate_checksum(destination, static_cast<std::size_t>(part.size)) == part.checksum);
+}
+
+bool ObjectPoolStorage::read_chunk(const String &chunkHash, std::uint8_t *destination, std::size_t length) const
+{
+	bool retVal = false;
+	bool isKnown = false;
+	bool isCompressed = false;
+
+	{
+		const std::lock_guard<std::mutex> lock(indexMutex);
+		auto knownChunk = knownChunks.find(chunkHash);
+		isKnown = (knownChunks.end() != knownChunk);
+		isCompressed = isKnown && knownChunk->second;
+	}
+
+	if (isKnown)
+	{
+		auto chunkStream = std::make_unique<FileInputStream>(get_chunk_file(chunkHash, isCompressed));
+
+		if (chunkStream->openedOk())
+		{
+			if (isCompressed)
+			{
+				// Decompressed straight into the pool, without a buffer for the compressed data
+				GZIPDecompressorInputStream decompressor(chunkStream.release(), true);
+				std::uint8_t extraByte;
+				retVal = (static_cast<std::size_t>(decompressor.read(destination, static_cast<int>(length))) == length) &&
+				  (0 == decompressor.read(&extraByte, 1));
+			}
+			else
+			{
+				retVal = (static_cast<std::size_t>(chunkStream->getTotalLength()) == length) &&
+				  (static_cast<std::size_t>(chunkStream->read(destination, static_cast<int>(length))) == length);
+			}
+		}
+	}
+	return retVal;
+}
+
+bool ObjectPoolStorage::remove_parts(isobus::NAME clientNAME, ClientManifest &manifest, const PartFilter &shouldRemove)
+{
+	bool retVal = false;
+	auto clientDirectory = get_client_directory(clientNAME);
+	std::vector<StoredPart> removedParts;
+	std::vector<StoredPart> keptParts;
+
+	for (const auto &part : manifest.parts)
+	{
+		if (shouldRemove(part))
+		{
+			removedParts.push_back(part);
+		}
+		else
+		{
+			keptParts.push_back(part);
+		}
+	}
+
+	// The manifest has to stop using the files and chunks before they are deleted
+	if ((!removedParts.empty()) && write_manifest(clientDirectory, keptParts))
+	{
+		{
+			const std::lock_guard<std::mutex> lock(indexMutex);
+			manifest.parts = std::move(keptParts);
+		}
+		retVal = release_parts(clientDirectory, removedParts);
+	}
+	return retVal;
+}
+
+bool ObjectPoolStorage::release_parts(const File &clientDirectory, const std::vector<StoredPart> &releasedParts)
+{
+	bool retVal = true;
+	StringArray releasedChunks;
+
+	{
+		const std::unique_lock<std::shared_mutex> fileLock(fileRemovalMutex);
+
+		for (const auto &part : releasedParts)
+		{
+			if (part.fileName.isNotEmpty())
+			{
+				// Older versions also saved a plain .iop copy of each .iopx file, with the same number
+				auto iopxFile = clientDirectory.getChildFile(part.fileName);
+				clientDirectory.getChildFile("object_pool_" + String(get_file_index(iopxFile)) + ".iop").deleteFile();
+				retVal &= iopxFile.deleteFile();
+			}
+			releasedChunks.addArray(part.chunks);
+		}
+	}
+	remove_unreferenced_chunks(releasedChunks);
+	return retVal;
+}
+
+void ObjectPoolStorage::remove_unreferenced_chunks(const StringArray &chunkHashes)
+{
+	std::set<String> referencedChunks;
+	std::vector<File> unreferencedChunkFiles;
+
+	// Loads don't use the index while they read, so they have to finish before any chunk is deleted
+	const std::unique_lock<std::shared_mutex> fileLock(fileRemovalMutex);
+
+	{
+		const std::lock_guard<std::mutex> lock(indexMutex);
+
+		for (const auto &manifest : manifests)
+		{
+			for (const auto &part : manifest.second.parts)
+			{
+				referencedChunks.insert(part.chunks.begin(), part.chunks.end());
+			}
+
+			// Chunks of a version still being saved are kept, though no manifest may refer to them yet, and
+			// so are the chunks of the version it replaces, which may have to be put back
+			for (const auto &part : manifest.second.store.parts)
+			{
+				referencedChunks.insert(part.chunks.begin(), part.chunks.end());
+			}
+
+			for (const auto &part : manifest.second.store.replacedParts)
+			{
+				referencedChunks.insert(part.chunks.begin(), part.chunks.end());
+			}
+		}
+
+		for (const auto &chunkHash : chunkHashes)
+		{
+			auto knownChunk = knownChunks.find(chunkHash);
+
+			if ((!chunkRemovalDisabled) && (referencedChunks.end() == referencedChunks.find(chunkHash)) && (knownChunks.end() != knownChunk))
+			{
+				unreferencedChunkFiles.push_back(get_chunk_file(chunkHash, knownChunk->second));
+				knownChunks.erase(knownChunk);
+			}
+		}
+	}
+
+	for (const auto &chunkFile : unreferencedChunkFiles)
+	{
+		chunkFile.deleteFile();
+	}
+}
+
+bool ObjectPoolStorage::write_manifest(const File &clientDirectory, const std::vector<StoredPart> &parts)
+{
+	bool retVal = false;
+	XmlElement manifestXml("ObjectPoolManifest");
+	manifestXml.setAttribute("Version", MANIFEST_VERSION);
+
+	for (const auto &part : parts)
+	{
+		auto partXml = manifestXml.createNewChildElement("Part");
+		partXml->setAttribute("Label", String::toHexString(part.label.data(), static_cast<int>(part.label.size()), 0));
+		partXml->setAttribute("Size", String(part.size));
+		partXml->setAttribute("Checksum", String::toHexString(static_cast<std::int64_t>(part.checksum)));
+
+		if (part.fileName.isNotEmpty())
+		{
+			partXml->setAttribute("File", part.fileName);
+		}
+		else
+		{
+			partXml->setAttribute("Chunks", part.chunks.joinIntoString(","));
+		}
+	}
+
+	MemoryOutputStream manifestText;
+	manifestXml.writeTo(manifestText);
+	retVal = write_file_durably(clientDirectory.getChildFile(MANIFEST_FILE_NAME), manifestText.getData(), manifestText.getDataSize()) &&
+	  sync_directory(clientDirectory);
+
+	if (!retVal)
+	{
+		isobus::CANStackLogger::warn("[VT Server]: Failed to write the object pool manifest in " + clientDirectory.getFileName().toStdString());
+	}
+	return retVal;
+}
+
+bool ObjectPoolStorage::write_file_durably(const File &file, const void *data, std::size_t length)
+{
+	bool retVal = false;
+
+	// Written next to the target and then renamed over it, so a power loss leaves either the old file or the new one
+	TemporaryFile temporaryFile(file);
+	auto fileStream = temporaryFile.getFile().createOutputStream();
+
+	if ((nullptr != fileStream) && fileStream->openedOk())
+	{
+		fileStream->write(data, length);
+
+		// Flushing a FileOutputStream also syncs it to the disk, so the data is there before the rename
+		fileStream->flush();
+		retVal = !fileStream->getStatus().failed();
+		fileStream.reset();
+		retVal = retVal && temporaryFile.overwriteTargetFileWithTemporary();
+	}
+	return retVal;
+}
+
+bool ObjectPoolStorage::sync_directory(const File &directoryToSync)
+{
+	bool retVal = true;
+
+#ifndef JUCE_WINDOWS
+	// A rename is only durable once the directory that holds it is synced. Windows has no
+	// equivalent, and NTFS journals renames itself.
+	auto directoryHandle = open(directoryToSync.getFullPathName().toRawUTF8(), O_RDONLY);
+
+	if (directoryHandle >= 0)
+	{
+		retVal = (0 == fsync(directoryHandle));
+		close(directoryHandle);
+	}
+	else
+	{
+		retVal = false;
+	}
+#else
+	ignoreUnused(directoryToSync);
+#endif
+	return retVal;
+}
+
+bool ObjectPoolStorage::read_manifest(const File &clientDirectory, ClientManifest &manifest)
+{
+	bool retVal = false;
+	auto manifestXml = XmlDocument::parse(clientDirectory.getChildFile(MANIFEST_FILE_NAME));
+
+	if ((nullptr != manifestXml) && manifestXml->hasTagName("ObjectPoolManifest"))
+	{
+		auto version = manifestXml->getIntAttribute("Version");
+
+		// Version 1 only knew .iopx files, which it listed as File elements
+		retVal = (1 == version) || (MANIFEST_VERSION == version);
+		const char *partTagName = (1 == version) ? "File" : "Part";
+		const char *fileAttributeName = (1 == version) ? "Name" : "File";
+
+		for (auto *partXml : manifestXml->getChildWithTagNameIterator(partTagName))
+		{
+			MemoryBlock label;
+			label.loadFromHexString(partXml->getStringAttribute("Label"));
+
+			if ((!retVal) || (VERSION_LABEL_LENGTH != label.getSize()))
+			{
+				retVal = false;
+				break;
+			}
+
+			StoredPart storedPart;
+			std::copy_n(static_cast<const std::uint8_t *>(label.getData()), storedPart.label.size(), storedPart.label.begin());
+			storedPart.fileName = partXml->getStringAttribute(fileAttributeName);
+			storedPart.chunks.addTokens(partXml->getStringAttribute("Chunks"), ",", "");
+			storedPart.chunks.removeEmptyStrings();
+			storedPart.size = partXml->getStringAttribute("Size").getLargeIntValue();
+			storedPart.checksum = static_cast<std::uint32_t>(partXml->getStringAttribute("Checksum").getHexValue64());
+			manifest.parts.push_back(storedPart);
+		}
+	}
+	return retVal;
+}
+
+ObjectPoolStorage::ClientManifest ObjectPoolStorage::index_directory(const File &clientDirectory)
+{
+	ClientManifest retVal;
+	auto iopxFiles = clientDirectory.findChildFiles(File::findFiles, false, "*.iopx");
+
+	// Files were numbered as they were saved, so this restores the order they were saved in
+	std::sort(iopxFiles.begin(), iopxFiles.end(), [](const File &first, const File &second) { return get_file_index(first) < get_file_index(second); });
+
+	for (const auto &file : iopxFiles)
+	{
+		MemoryBlock contents;
+
+		if (file.loadFileAsData(contents) && (contents.getSize() >= VERSION_LABEL_LENGTH))
+		{
+			auto data = static_cast<const std::uint8_t *>(contents.getData());
+			StoredPart storedPart;
+			std::copy_n(data, storedPart.label.size(), storedPart.label.begin());
+			storedPart.fileName = file.getFileName();
+			storedPart.size = static_cast<std::int64_t>(contents.getSize() - storedPart.label.size());
+			storedPart.checksum = calculate_checksum(data + storedPart.label.size(), contents.getSize() - storedPart.label.size());
+			retVal.parts.push_back(storedPart);
+		}
+	}
+	return retVal;
+}
+
+bool ObjectPoolStorage::labels_match(const VersionLabel &label, const std::vector<std::uint8_t> &otherLabel)
+{
+	return (label.size() == otherLabel.size()) && std::equal(label.begin(), label.end(), otherLabel.begin());
+}
+
+std::uint32_t ObjectPoolStorage::calculate_checksum(const std::uint8_t *data, std::size_t length)
+{
+	// Standard reflected CRC-32 (as used by zip and PNG), with the table built on first use
+	static const auto crcTable = []() {
+		std::array<std::uint32_t, 256> table;
+
+		for (std::uint32_t i = 0; i < table.size(); i++)
+		{
+			std::uint32_t value = i;
+
+			for (int bit = 0; bit < 8; bit++)
+			{
+				value = (value & 1) ? (0xEDB88320 ^ (value >> 1)) : (value >> 1);
+			}
+			table[i] = value;
+		}
+		return table;
+	}();
+	std::uint32_t retVal = 0xFFFFFFFF;
+
+	for (std::size_t i = 0; i < length; i++)
+	{
+		retVal = crcTable[(retVal ^ data[i]) & 0xFF] ^ (retVal >> 8);
+	}
+	return retVal ^ 0xFFFFFFFF;
+}
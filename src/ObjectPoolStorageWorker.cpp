@@ -0,0 +1,167 @@
+/*******************************************************************************
+** @file       ObjectPoolStorageWorker.cpp
+** @author     The Open-Agriculture Developers
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "ObjectPoolStorageWorker.hpp"
+
+ObjectPoolStorageWorker::ObjectPoolStorageWorker(ObjectPoolStorage &storageToUse) :
+  Thread("Object Pool Storage"),
+  storage(storageToUse)
+{
+	startThread();
+}
+
+ObjectPoolStorageWorker::~ObjectPoolStorageWorker()
+{
+	// The thread finishes what is queued before it exits, so no saved pool is lost
+	stopThread(10000);
+}
+
+bool ObjectPoolStorageWorker::save_version(const std::vector<std::uint8_t> &objectPool, const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME, std::size_t expectedPartCount)
+{
+	auto result = std::make_shared<std::promise<bool>>();
+	auto succeeded = result->get_future();
+
+	// Queued rather than run here so that it lands after any delete the client asked for first
+	queue_job({ Operation::SaveVersion, clientNAME, versionLabel, objectPool, Time::getMillisecondCounter(), expectedPartCount, result });
+	return succeeded.get();
+}
+
+void ObjectPoolStorageWorker::delete_version(const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME)
+{
+	queue_job({ Operation::DeleteVersion, clientNAME, versionLabel, {}, Time::getMillisecondCounter() });
+}
+
+void ObjectPoolStorageWorker::delete_all_versions(isobus::NAME clientNAME)
+{
+	queue_job({ Operation::DeleteAllVersions, clientNAME, {}, {}, Time::getMillisecondCounter() });
+}
+
+void ObjectPoolStorageWorker::clear()
+{
+	queue_job({ Operation::Clear, isobus::NAME(0), {}, {}, Time::getMillisecondCounter() });
+}
+
+bool ObjectPoolStorageWorker::is_delete_pending(const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME)
+{
+	const std::lock_guard<std::mutex> lock(jobMutex);
+	bool retVal = false;
+
+	for (const auto &job : jobs)
+	{
+		if ((Operation::Clear == job.operation) ||
+		    ((job.clientNAME == clientNAME) &&
+		     ((Operation::DeleteAllVersions == job.operation) ||
+		      ((Operation::DeleteVersion == job.operation) && (job.versionLabel == versionLabel)))))
+		{
+			retVal = true;
+			break;
+		}
+	}
+	return retVal;
+}
+
+void ObjectPoolStorageWorker::wait_until_idle()
+{
+	std::unique_lock<std::mutex> lock(jobMutex);
+	idleCondition.wait(lock, [this]() { return jobs.empty(); });
+}
+
+std::vector<ObjectPoolStorageWorker::Completion> ObjectPoolStorageWorker::take_completions()
+{
+	const std::lock_guard<std::mutex> lock(jobMutex);
+	std::vector<Completion> retVal;
+	retVal.swap(completions);
+	return retVal;
+}
+
+void ObjectPoolStorageWorker::run()
+{
+	while (!threadShouldExit())
+	{
+		if (!run_next_job())
+		{
+			wait(-1);
+		}
+	}
+
+	while (run_next_job())
+	{
+	}
+}
+
+void ObjectPoolStorageWorker::queue_job(Job &&job)
+{
+	{
+		const std::lock_guard<std::mutex> lock(jobMutex);
+		jobs.push_back(std::move(job));
+	}
+	notify();
+}
+
+bool ObjectPoolStorageWorker::run_next_job()
+{
+	bool retVal = false;
+	Job *job = nullptr;
+
+	{
+		const std::lock_guard<std::mutex> lock(jobMutex);
+
+		// The job stays queued while it runs, so is_delete_pending still sees it. Other threads only
+		// push to the back of the deque, which leaves a reference to the front element valid.
+		if (!jobs.empty())
+		{
+			job = &jobs.front();
+			retVal = true;
+		}
+	}
+
+	if (retVal)
+	{
+		bool succeeded = false;
+
+		switch (job->operation)
+		{
+			case Operation::SaveVersion:
+			{
+				succeeded = storage.save_version(job->objectPool, job->versionLabel, job->clientNAME, job->expectedPartCount, job->requestTime);
+			}
+			break;
+
+			case Operation::DeleteVersion:
+			{
+				succeeded = storage.delete_version(job->versionLabel, job->clientNAME);
+			}
+			break;
+
+			case Operation::DeleteAllVersions:
+			{
+				succeeded = storage.delete_all_versions(job->clientNAME);
+			}
+			break;
+
+			case Operation::Clear:
+			{
+				succeeded = storage.clear();
+			}
+			break;
+		}
+
+		std::shared_ptr<std::promise<bool>> result;
+
+		{
+			const std::lock_guard<std::mutex> lock(jobMutex);
+			completions.push_back({ job->operation, job->clientNAME, std::move(job->versionLabel), succeeded });
+			result = std::move(job->result);
+			jobs.pop_front();
+		}
+		idleCondition.notify_all();
+
+		if (nullptr != result)
+		{
+			result->set_value(succeeded);
+		}
+	}
+	return retVal;
+}
@@ -0,0 +1,130 @@
+/*******************************************************************************
+** @file       PictureGraphicCache.cpp
+** @author     The Open-Agriculture Developers
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "PictureGraphicCache.hpp"
+
+#include <tuple>
+
+std::list<PictureGraphicCache::CachedImage> PictureGraphicCache::images;
+std::map<PictureGraphicCache::ImageKey, std::list<PictureGraphicCache::CachedImage>::iterator> PictureGraphicCache::imageLookup;
+std::map<const isobus::VirtualTerminalServerManagedWorkingSet *, std::uint32_t> PictureGraphicCache::paletteVersions;
+std::map<const isobus::VirtualTerminalServerManagedWorkingSet *, PictureGraphicDecoder::ColourLookupTable> PictureGraphicCache::colourLookupTables;
+std::size_t PictureGraphicCache::totalSizeInBytes = 0;
+std::size_t PictureGraphicCache::memoryLimitInBytes = 64 * 1024 * 1024;
+
+bool PictureGraphicCache::ImageKey::operator<(const ImageKey &other) const
+{
+	return std::tie(workingSet, paletteVersion, objectID, width, height, transparencyColour, transparent) <
+	  std::tie(other.workingSet, other.paletteVersion, other.objectID, other.width, other.height, other.transparencyColour, other.transparent);
+}
+
+Image PictureGraphicCache::find_image(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, const isobus::PictureGraphic &pictureGraphic)
+{
+	Image retVal;
+	auto cachedImage = imageLookup.find(make_key(workingSet.get(), pictureGraphic));
+
+	if (imageLookup.end() != cachedImage)
+	{
+		// Move it to the front, since it's now the most recently used
+		images.splice(images.begin(), images, cachedImage->second);
+		retVal = cachedImage->second->image;
+	}
+	return retVal;
+}
+
+void PictureGraphicCache::store_image(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, const isobus::PictureGraphic &pictureGraphic, const Image &image)
+{
+	if (image.isValid())
+	{
+		auto key = make_key(workingSet.get(), pictureGraphic);
+		auto existingImage = imageLookup.find(key);
+
+		if (imageLookup.end() != existingImage)
+		{
+			totalSizeInBytes -= existingImage->second->sizeInBytes;
+			images.erase(existingImage->second);
+			imageLookup.erase(existingImage);
+		}
+
+		std::size_t sizeInBytes = static_cast<std::size_t>(image.getWidth()) * static_cast<std::size_t>(image.getHeight()) * 4;
+		images.push_front({ key, image, sizeInBytes });
+		imageLookup[key] = images.begin();
+		totalSizeInBytes += sizeInBytes;
+		evict_to_limit();
+	}
+}
+
+const PictureGraphicDecoder::ColourLookupTable &PictureGraphicCache::get_colour_lookup_table(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	auto lookupTable = colourLookupTables.find(workingSet.get());
+
+	if (colourLookupTables.end() == lookupTable)
+	{
+		lookupTable = colourLookupTables.emplace(workingSet.get(), PictureGraphicDecoder::create_lookup_table(workingSet)).first;
+	}
+	return lookupTable->second;
+}
+
+void PictureGraphicCache::on_palette_changed(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	paletteVersions[workingSet.get()]++;
+	colourLookupTables.erase(workingSet.get());
+	remove_images(workingSet.get());
+}
+
+void PictureGraphicCache::remove_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	paletteVersions.erase(workingSet.get());
+	colourLookupTables.erase(workingSet.get());
+	remove_images(workingSet.get());
+}
+
+void PictureGraphicCache::set_memory_limit(std::size_t maximumBytes)
+{
+	memoryLimitInBytes = maximumBytes;
+	evict_to_limit();
+}
+
+PictureGraphicCache::ImageKey PictureGraphicCache::make_key(const isobus::VirtualTerminalServerManagedWorkingSet *workingSet, const isobus::PictureGraphic &pictureGraphic)
+{
+	ImageKey retVal;
+	auto paletteVersion = paletteVersions.find(workingSet);
+
+	retVal.workingSet = workingSet;
+	retVal.paletteVersion = (paletteVersions.end() != paletteVersion) ? paletteVersion->second : 0;
+	retVal.objectID = pictureGraphic.get_id();
+	retVal.width = pictureGraphic.get_width();
+	retVal.height = pictureGraphic.get_height();
+	retVal.transparent = pictureGraphic.get_option(isobus::PictureGraphic::Options::Transparent);
+	retVal.transparencyColour = retVal.transparent ? pictureGraphic.get_transparency_colour() : 0;
+	return retVal;
+}
+
+void PictureGraphicCache::remove_images(const isobus::VirtualTerminalServerManagedWorkingSet *workingSet)
+{
+	for (auto image = images.begin(); image != images.end();)
+	{
+		if (workingSet == image->key.workingSet)
+		{
+			totalSizeInBytes -= image->sizeInBytes;
+			imageLookup.erase(image->key);
+			image = images.erase(image);
+		}
+		else
+		{
+			image++;
+		}
+	}
+}
+
+void PictureGraphicCache::evict_to_limit()
+{
+	while ((totalSizeInBytes > memoryLimitInBytes) && (!images.empty()))
+	{
+		totalSizeInBytes -= images.back().sizeInBytes;
+		imageLookup.erase(images.back().key);
+		images.pop_back();
+	}
+}
@@ -0,0 +1,51 @@
+/*******************************************************************************
+** @file       PictureGraphicDecoder.cpp
+** @author     The Open-Agriculture Developers
+** @copyright  The Open-Agriculture Developers
+*******************************************************************************/
+#include "PictureGraphicDecoder.hpp"
+
+PictureGraphicDecoder::ColourLookupTable PictureGraphicDecoder::create_lookup_table(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
+{
+	ColourLookupTable retVal;
+
+	for (std::size_t i = 0; i < retVal.size(); i++)
+	{
+		auto vtColour = workingSet->get_colour(static_cast<std::uint8_t>(i));
+		retVal[i] = Colour::fromFloatRGBA(vtColour.r, vtColour.g, vtColour.b, 1.0f).getPixelARGB().getNativeARGB();
+	}
+	return retVal;
+}
+
+void PictureGraphicDecoder::set_transparent_colour(ColourLookupTable &lookupTable, std::uint8_t transparencyColour)
+{
+	lookupTable[transparencyColour] = Colours::transparentBlack.getPixelARGB().getNativeARGB();
+}
+
+void PictureGraphicDecoder::decode_indexed_pixels(const std::uint8_t *pixelData, std::size_t pixelDataLength, const ColourLookupTable &lookupTable, Image &destination)
+{
+	const auto width = static_cast<std::size_t>(destination.getWidth());
+	Image::BitmapData bitmap(destination, Image::BitmapData::writeOnly);
+
+	// Each pixel is written as a whole 32 bit word, which relies on the ARGB layout
+	jassert(4 == bitmap.pixelStride);
+
+	for (int y = 0; y < destination.getHeight(); y++)
+	{
+		const std::size_t rowStart = static_cast<std::size_t>(y) * width;
+
+		if ((rowStart + width) > pixelDataLength)
+		{
+			// Truncated data, leave the rest of the image transparent
+			break;
+		}
+
+		const std::uint8_t *sourceRow = pixelData + rowStart;
+		auto destinationRow = reinterpret_cast<std::uint32_t *>(bitmap.getLinePointer(y));
+
+		for (std::size_t x = 0; x < width; x++)
+		{
+			destinationRow[x] = lookupTable[sourceRow[x]];
+		}
+	}
+}
@@ -7,8 +7,10 @@
 
 #include "AckSettingsWindow.hpp"
 #include "AlarmMaskAudio.h"
+#include "CANTraceFile.hpp"
 #include "JuceManagedWorkingSetCache.hpp"
 #include "Main.hpp"
+#include "PictureGraphicCache.hpp"
 #include "isobus/utility/system_timing.hpp"
 
 #include "SoftKeyMaskRenderAreaComponent.hpp"
@@ -20,6 +22,7 @@
 #endif
 #include "isobus/isobus/can_stack_logger.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iomanip>
@@ -33,11 +36,14 @@ ServerMainComponent::ServerMainComponent(
   const std::string &canLogPath_,
   std::uint8_t vtNumberArg,
   std::string screenCaptureDir) :
-  VirtualTerminalServer(serverControlFunction), screenCaptureDirArgument(screenCaptureDir), workingSetSelector(*this), dataMaskRenderer(*this), softKeyMaskRenderer(*this), parentCANDrivers(canDrivers), canLogPath(canLogPath_)
+  VirtualTerminalServer(serverControlFunction), screenCaptureDirArgument(screenCaptureDir), canLogPath(canLogPath_), poolStorage(File(getAppDataDir()).getChildFile(ISO_DATA_PATH)), storageWorker(poolStorage), workingSetSelector(*this), dataMaskRenderer(*this), softKeyMaskRenderer(*this), parentCANDrivers(canDrivers)
 {
 	isobus::CANStackLogger::set_can_stack_logger_sink(&logger);
 	isobus::CANStackLogger::set_log_level(isobus::CANStackLogger::LoggingLevel::Info);
 
+	// Must be registered before the server so that commands are recorded before they are processed
+	objectChangeTracker.initialize(serverControlFunction);
+	latencyMonitor.initialize(serverControlFunction);
 	VirtualTerminalServer::initialize();
 
 	logger.setVisible(true);
@@ -95,7 +101,7 @@ ServerMainComponent::ServerMainComponent(
 
 	setApplicationCommandManagerToWatch(&mCommandManager);
 	mCommandManager.registerAllCommandsForTarget(this);
-	startTimer(50);
+	triggerAsyncUpdate();
 
 	setWantsKeyboardFocus(true);
 	addKeyListener(this);
@@ -103,6 +109,8 @@ ServerMainComponent::ServerMainComponent(
 
 ServerMainComponent::~ServerMainComponent()
 {
+	stopTimer();
+	cancelPendingUpdate();
 	setApplicationCommandManagerToWatch(nullptr);
 }
 
@@ -268,51 +276,16 @@ void ServerMainComponent::send_alarm_ack_command(KeyActivationCode activationCod
 
 std::vector<std::array<std::uint8_t, 7>> ServerMainComponent::get_versions(isobus::NAME clientNAME)
 {
-	std::ostringstream nameString;
 	std::vector<std::array<std::uint8_t, 7>> retVal;
-	nameString << std::hex << std::setfill('0') << std::setw(16) << clientNAME.get_full_name();
-	File isoDirectory(getAppDataDir() +
-	                  File::getSeparatorString() +
-	                  ISO_DATA_PATH +
-	                  File::getSeparatorString() +
-	                  nameString.str());
 
-	if (isoDirectory.exists() && isoDirectory.isDirectory())
+	// Answered from the storage's manifests, leaving out versions that are still queued to be deleted
+	for (const auto &label : poolStorage.get_versions(clientNAME))
 	{
-		auto directoryFiles = isoDirectory.findChildFiles(File::TypesOfFileToFind::findFiles, false, "*.iopx");
-
-		for (auto &file : directoryFiles)
+		if (!storageWorker.is_delete_pending(std::vector<std::uint8_t>(label.begin(), label.end()), clientNAME))
 		{
-			std::ifstream iopxFile(file.getFullPathName().toStdString(), std::ios::binary);
-
-			if (iopxFile.is_open())
-			{
-				iopxFile.unsetf(std::ios::skipws);
-				std::array<std::uint8_t, 7> versionLabel;
-				iopxFile.read(reinterpret_cast<char *>(versionLabel.data()), 7);
-
-				// Only add the version label if it is not already in the list
-				bool versionAlreadyInList = false;
-				for (const auto &version : retVal)
-				{
-					if (version == versionLabel)
-					{
-						versionAlreadyInList = true;
-						break;
-					}
-				}
-
-				if (!versionAlreadyInList)
-				{
-					retVal.push_back(versionLabel);
-				}
-			}
+			retVal.push_back(label);
 		}
 	}
-	else
-	{
-		isobus::CANStackLogger::info("[VT Server]: No saved object pool data for client: " + nameString.str());
-	}
 	return retVal;
 }
 
@@ -324,93 +297,41 @@ std::vector<std::uint8_t> ServerMainComponent::get_supported_objects() const
 
 std::vector<std::uint8_t> ServerMainComponent::load_version(const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME)
 {
-	std::ostringstream nameString;
-	std::vector<std::uint8_t> loadedIOPData;
-	std::vector<std::uint8_t> loadedVersionLabel(7);
-	std::string path = (getAppDataDir() +
-	                    File::getSeparatorString() +
-	                    ISO_DATA_PATH +
-	                    File::getSeparatorString())
-	                     .toStdString();
-	nameString << std::hex << std::setfill('0') << std::setw(16) << clientNAME.get_full_name();
+	std::vector<std::uint8_t> retVal;
 
-	if ((std::filesystem::is_directory(path + nameString.str()) ||
-	     std::filesystem::exists(path + nameString.str())) &&
-	    (7 == versionLabel.size()))
+	if (!storageWorker.is_delete_pending(versionLabel, clientNAME))
 	{
-		for (const auto &entry : std::filesystem::directory_iterator(path + nameString.str()))
-		{
-			if (entry.path().has_extension() && entry.path().extension() == ".iopx")
-			{
-				std::ifstream iopxFile(entry.path(), std::ios::binary);
-
-				if (iopxFile.is_open())
-				{
-					iopxFile.unsetf(std::ios::skipws);
-					iopxFile.read(reinterpret_cast<char *>(loadedVersionLabel.data()), 7);
-
-					if (7 == loadedVersionLabel.size())
-					{
-						bool versionMatches = true;
-						for (std::uint8_t i = 0; i < 7; i++)
-						{
-							if (loadedVersionLabel.at(i) != versionLabel.at(i))
-							{
-								versionMatches = false;
-								break;
-							}
-						}
+		retVal = poolStorage.load_version(versionLabel, clientNAME);
+	}
 
-						if (versionMatches)
-						{
-							iopxFile.seekg(7, std::ios::beg);
-							loadedIOPData.insert(loadedIOPData.end(), std::istream_iterator<std::uint8_t>(iopxFile), std::istream_iterator<std::uint8_t>());
-						}
-					}
-				}
-			}
-		}
+	if (!retVal.empty())
+	{
+		// The server parses the pool once this returns, so start checking for the parse to finish
+		poolParsePending = true;
+		triggerAsyncUpdate();
 	}
-	return loadedIOPData;
+	return retVal;
 }
 
 bool ServerMainComponent::save_version(const std::vector<std::uint8_t> &objectPool, const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME)
 {
+	// The server answers the client from this call, so the save has to be on the disk before it returns.
+	// The working set's part count lets the storage commit the version as soon as its last part is saved.
 	bool retVal = false;
-	std::string path = (getAppDataDir() +
-	                    File::getSeparatorString() +
-	                    String(ISO_DATA_PATH))
-	                     .toStdString();
+	std::size_t partCount = 0;
 
-	// Main saved data folder
-	if (!std::filesystem::is_directory(path) || !std::filesystem::exists(path))
+	for (auto &ws : managedWorkingSetList)
 	{
-		std::filesystem::create_directory(path);
-	}
-
-	// NAME specific folder
-	std::ostringstream nameString;
-	nameString << std::hex << std::setfill('0') << std::setw(16) << clientNAME.get_full_name();
-
-	if (!std::filesystem::is_directory(path + "/" + nameString.str()) || !std::filesystem::exists(path + "/" + nameString.str()))
-	{ // Check if src folder exists
-		std::filesystem::create_directory(path + "/" + nameString.str()); // create src folder
+		if (ws->get_control_function()->get_NAME() == clientNAME)
+		{
+			partCount = ws->get_number_iop_files();
+			break;
+		}
 	}
 
-	std::ofstream iopxFile(path + "/" + nameString.str() + "/object_pool_with_label_" + std::to_string(number_of_iop_files_in_directory(path + "/" + nameString.str())) + ".iopx", std::ios::trunc | std::ios::binary);
-	std::ofstream iopFile(path + "/" + nameString.str() + "/object_pool_" + std::to_string(number_of_iop_files_in_directory(path + "/" + nameString.str())) + ".iop", std::ios::trunc | std::ios::binary);
-
-	if (iopxFile.is_open())
-	{
-		iopxFile.write(reinterpret_cast<const char *>(versionLabel.data()), static_cast<std::streamsize>(versionLabel.size()));
-		iopxFile.write(reinterpret_cast<const char *>(objectPool.data()), static_cast<std::streamsize>(objectPool.size()));
-		iopxFile.close();
-		retVal = true;
-	}
-	if (iopFile.is_open())
+	if (ObjectPoolStorage::VERSION_LABEL_LENGTH == versionLabel.size())
 	{
-		iopFile.write(reinterpret_cast<const char *>(objectPool.data()), static_cast<std::streamsize>(objectPool.size()));
-		iopFile.close();
+		retVal = storageWorker.save_version(objectPool, versionLabel, clientNAME, partCount);
 	}
 	return retVal;
 }
@@ -418,57 +339,14 @@ bool ServerMainComponent::save_version(const std::vector<std::uint8_t> &objectPo
 bool ServerMainComponent::delete_version(const std::vector<std::uint8_t> &versionLabel, isobus::NAME clientNAME)
 {
 	bool retVal = false;
-	std::ostringstream nameString;
-	std::vector<std::uint8_t> loadedVersionLabel(7);
-	std::vector<std::filesystem::directory_entry> filesToRemove;
-	std::string path = (getAppDataDir() +
-	                    File::getSeparatorString() +
-	                    ISO_DATA_PATH +
-	                    File::getSeparatorString())
-	                     .toStdString();
-	nameString << std::hex << std::setfill('0') << std::setw(16) << clientNAME.get_full_name();
 
-	if ((std::filesystem::is_directory(path + nameString.str()) ||
-	     std::filesystem::exists(path + nameString.str())) &&
-	    (7 == versionLabel.size()))
+	for (const auto &label : get_versions(clientNAME))
 	{
-		for (const auto &entry : std::filesystem::directory_iterator(path + nameString.str()))
+		if (std::equal(label.begin(), label.end(), versionLabel.begin(), versionLabel.end()))
 		{
-			if (entry.path().has_extension() && entry.path().extension() == ".iopx")
-			{
-				std::ifstream iopxFile(entry.path(), std::ios::binary);
-
-				if (iopxFile.is_open())
-				{
-					iopxFile.unsetf(std::ios::skipws);
-					iopxFile.read(reinterpret_cast<char *>(loadedVersionLabel.data()), 7);
-
-					if (7 == loadedVersionLabel.size())
-					{
-						bool versionMatches = true;
-						for (std::uint8_t i = 0; i < 7; i++)
-						{
-							if (loadedVersionLabel.at(i) != versionLabel.at(i))
-							{
-								versionMatches = false;
-								break;
-							}
-						}
-
-						if (versionMatches)
-						{
-							iopxFile.close();
-							filesToRemove.push_back(entry);
-							retVal = true;
-						}
-					}
-				}
-			}
-		}
-
-		for (const auto &entry : filesToRemove)
-		{
-			retVal &= std::filesystem::remove(entry);
+			retVal = true;
+			storageWorker.delete_version(versionLabel, clientNAME);
+			break;
 		}
 	}
 	return retVal;
@@ -476,32 +354,11 @@ bool ServerMainComponent::delete_version(const std::vector<std::uint8_t> &versio
 
 bool ServerMainComponent::delete_all_versions(isobus::NAME clientNAME)
 {
-	bool retVal = false;
-	std::ostringstream nameString;
-	std::vector<std::uint8_t> loadedVersionLabel(7);
-	std::vector<std::filesystem::directory_entry> filesToRemove;
-	auto path = (getAppDataDir() +
-	             File::getSeparatorString() +
-	             ISO_DATA_PATH +
-	             File::getSeparatorString())
-	              .toStdString();
-	nameString << std::hex << std::setfill('0') << std::setw(16) << clientNAME.get_full_name();
+	bool retVal = !get_versions(clientNAME).empty();
 
-	if ((std::filesystem::is_directory(path + nameString.str()) ||
-	     std::filesystem::exists(path + nameString.str())))
+	if (retVal)
 	{
-		for (const auto &entry : std::filesystem::directory_iterator(path + nameString.str()))
-		{
-			if (entry.path().has_extension() && entry.path().extension() == ".iopx")
-			{
-				filesToRemove.push_back(entry);
-			}
-		}
-
-		for (const auto &entry : filesToRemove)
-		{
-			retVal &= std::filesystem::remove(entry);
-		}
+		storageWorker.delete_all_versions(clientNAME);
 	}
 	return retVal;
 }
@@ -515,6 +372,7 @@ bool ServerMainComponent::delete_object_pool(isobus::NAME clientNAME)
 		if (ws->get_control_function()->get_NAME() == clientNAME)
 		{
 			ws->request_deletion(); // We'll delete it on our next update on our normal thread.
+			triggerAsyncUpdate();
 			retVal = true;
 			break;
 		}
@@ -536,7 +394,24 @@ std::uint8_t ServerMainComponent::get_user_layout_softkeymask_bg_color() const
 
 void ServerMainComponent::timerCallback()
 {
-	if ((isobus::SystemTiming::time_expired_ms(statusMessageTimestamp_ms, 1000)) &&
+	process_updates();
+}
+
+void ServerMainComponent::handleAsyncUpdate()
+{
+	process_updates();
+}
+
+void ServerMainComponent::UpdatePoster::handleAsyncUpdate()
+{
+	mParent.process_updates();
+}
+
+void ServerMainComponent::process_updates()
+{
+	drain_ui_commands();
+
+	if ((isobus::SystemTiming::time_expired_ms(statusMessageTimestamp_ms, STATUS_MESSAGE_INTERVAL_MS)) &&
 	    (send_status_message()))
 	{
 		statusMessageTimestamp_ms = isobus::SystemTiming::get_timestamp_ms();
@@ -560,7 +435,11 @@ void ServerMainComponent::timerCallback()
 		if (isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Success == ws->get_object_pool_processing_state())
 		{
 			ws->join_parsing_thread();
+			poolParsePending = false;
 
+			// Any masks and images built from a previous version of this pool are now stale
+			JuceManagedWorkingSetCache::invalidate(ws);
+			PictureGraphicCache::remove_working_set(ws);
 			workingSetSelector.update_drawn_working_sets(managedWorkingSetList);
 
 			auto workingSetObject = std::static_pointer_cast<isobus::WorkingSet>(ws->get_working_set_object());
@@ -594,6 +473,7 @@ void ServerMainComponent::timerCallback()
 		else if (isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Fail == ws->get_object_pool_processing_state())
 		{
 			ws->join_parsing_thread();
+			poolParsePending = false;
 
 			const bool isInitialNonVolatileLoadResponse =
 			  ws->get_was_object_pool_loaded_from_non_volatile_memory() &&
@@ -608,7 +488,7 @@ void ServerMainComponent::timerCallback()
 				send_end_of_object_pool_response(true, isobus::NULL_OBJECT_ID, ws->get_object_pool_faulting_object_id(), 0, ws->get_control_function());
 			}
 		}
-		else if (isobus::SystemTiming::time_expired_ms(ws->get_working_set_maintenance_message_timestamp_ms(), 3000) || ws->is_deletion_requested())
+		else if (isobus::SystemTiming::time_expired_ms(ws->get_working_set_maintenance_message_timestamp_ms(), MAINTENANCE_MESSAGE_TIMEOUT_MS) || ws->is_deletion_requested())
 		{
 			managedWorkingSetIopLoadStateMap[ws] = false;
 			dataMaskRenderer.on_working_set_disconnect(ws);
@@ -659,12 +539,12 @@ void ServerMainComponent::timerCallback()
 			if (dataMaskRenderer.needsRepaint() || needToRepaint)
 			{
 				needToRepaint = false;
-				repaint_data_and_soft_key_mask();
+				update_changed_objects();
 			}
 
 			for (auto &heldButton : heldButtons)
 			{
-				if (isobus::SystemTiming::time_expired_ms(heldButton.timestamp_ms, 200))
+				if (isobus::SystemTiming::time_expired_ms(heldButton.timestamp_ms, HELD_BUTTON_REPEAT_INTERVAL_MS))
 				{
 					bool sentMessage = false;
 
@@ -704,6 +584,59 @@ void ServerMainComponent::timerCallback()
 	{
 		workingSetSelector.update_iop_load_indicators();
 	}
+
+	if (showLatencyOverlay && isobus::SystemTiming::time_expired_ms(latencyOverlayTimestamp_ms, 1000))
+	{
+		latencyOverlayTimestamp_ms = isobus::SystemTiming::get_timestamp_ms();
+		repaint(dataMaskRenderer.getBounds());
+	}
+	report_storage_completions();
+	schedule_next_update();
+}
+
+void ServerMainComponent::schedule_next_update()
+{
+	// Changes are posted as they happen, so the timer only has to wake up for work that is due at a
+	// known time, or to check on things that can't post anything, like the parsing thread
+	const auto now = isobus::SystemTiming::get_timestamp_ms();
+	auto time_until = [now](std::uint32_t timestamp_ms, std::uint32_t interval_ms) {
+		const std::uint32_t elapsed_ms = now - timestamp_ms;
+		return (elapsed_ms < interval_ms) ? (interval_ms - elapsed_ms) : 1;
+	};
+	std::uint32_t interval_ms = time_until(statusMessageTimestamp_ms, STATUS_MESSAGE_INTERVAL_MS);
+
+	if (poolParsePending)
+	{
+		interval_ms = std::min(interval_ms, POOL_PARSE_POLL_INTERVAL_MS);
+	}
+
+	for (const auto &ws : managedWorkingSetList)
+	{
+		auto state = ws->get_object_pool_processing_state();
+
+		if ((isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Running == state) ||
+		    (isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Success == state) ||
+		    (isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Fail == state))
+		{
+			interval_ms = std::min(interval_ms, POOL_PARSE_POLL_INTERVAL_MS);
+		}
+		else if (ws->is_object_pool_transfer_in_progress())
+		{
+			interval_ms = std::min(interval_ms, POOL_TRANSFER_UPDATE_INTERVAL_MS);
+		}
+		interval_ms = std::min(interval_ms, time_until(ws->get_working_set_maintenance_message_timestamp_ms(), MAINTENANCE_MESSAGE_TIMEOUT_MS + 1));
+	}
+
+	for (const auto &heldButton : heldButtons)
+	{
+		interval_ms = std::min(interval_ms, time_until(heldButton.timestamp_ms, HELD_BUTTON_REPEAT_INTERVAL_MS + 1));
+	}
+
+	if (showLatencyOverlay)
+	{
+		interval_ms = std::min(interval_ms, time_until(latencyOverlayTimestamp_ms, STATUS_MESSAGE_INTERVAL_MS + 1));
+	}
+	startTimer(static_cast<int>(interval_ms));
 }
 
 void ServerMainComponent::paint(juce::Graphics &g)
@@ -733,6 +666,22 @@ void ServerMainComponent::paint(juce::Graphics &g)
 	g.drawText(statusText, statusArea, juce::Justification::centredLeft);
 }
 
+void ServerMainComponent::paintOverChildren(juce::Graphics &g)
+{
+	auto clipBounds = g.getClipBounds();
+
+	// Children are painted before this, so any change that was noticed has reached the screen
+	if (clipBounds.intersects(dataMaskRenderer.getBounds()) || clipBounds.intersects(softKeyMaskRenderer.getBounds()))
+	{
+		latencyMonitor.on_paint_finished();
+	}
+
+	if (showLatencyOverlay)
+	{
+		draw_latency_overlay(g);
+	}
+}
+
 void ServerMainComponent::resized()
 {
 	// This is called when the MainContentComponent is resized.
@@ -774,11 +723,14 @@ void ServerMainComponent::getAllCommands(juce::Array<juce::CommandID> &allComman
 	allCommands.add(static_cast<int>(CommandIDs::ConfigureReportedHardware));
 	allCommands.add(static_cast<int>(CommandIDs::ConfigureShortcuts));
 	allCommands.add(static_cast<int>(CommandIDs::ConfigureLogging));
+	allCommands.add(static_cast<int>(CommandIDs::ConfigureObjectPoolStorage));
 	allCommands.add(static_cast<int>(CommandIDs::GenerateLogPackage));
 	allCommands.add(static_cast<int>(CommandIDs::GenerateLogPackageFromCurrentSession));
 	allCommands.add(static_cast<int>(CommandIDs::ClearISOData));
 	allCommands.add(static_cast<int>(CommandIDs::StartStop));
 	allCommands.add(static_cast<int>(CommandIDs::AutoStart));
+	allCommands.add(static_cast<int>(CommandIDs::ShowLatencyOverlay));
+	allCommands.add(static_cast<int>(CommandIDs::SaveLatencyReport));
 #ifdef JUCE_WINDOWS
 	allCommands.add(static_cast<int>(CommandIDs::ConfigureCANHardware));
 #elif JUCE_LINUX
@@ -820,6 +772,12 @@ void ServerMainComponent::getCommandInfo(juce::CommandID commandID, ApplicationC
 		}
 		break;
 
+		case CommandIDs::ConfigureObjectPoolStorage:
+		{
+			result.setInfo("Saved Object Pools", "Change how object pools that clients save are stored", "Configure", 0);
+		}
+		break;
+
 		case CommandIDs::GenerateLogPackage:
 		{
 			result.setInfo("Generate Diagnostic Package", "Creates a zip file of diagnostic information", "Troubleshooting", 0);
@@ -862,6 +820,18 @@ void ServerMainComponent::getCommandInfo(juce::CommandID commandID, ApplicationC
 		}
 		break;
 
+		case CommandIDs::ShowLatencyOverlay:
+		{
+			result.setInfo("Show Command Latency", "Shows how long commands take from being received until they are drawn", "Troubleshooting", showLatencyOverlay ? ApplicationCommandInfo::CommandFlags::isTicked : 0);
+		}
+		break;
+
+		case CommandIDs::SaveLatencyReport:
+		{
+			result.setInfo("Save Command Latency Report", "Saves the command latency percentiles to a CSV file", "Troubleshooting", 0);
+		}
+		break;
+
 		case CommandIDs::NoCommand:
 		default:
 			break;
@@ -969,6 +939,9 @@ bool ServerMainComponent::perform(const InvocationInfo &info)
 			popupMenu->addTextBlock("Save IOP data before parsing. This allows providing IOP data for debugging parser crashes.");
 			popupMenu->addComboBox("Save IOP data before parsing", { "No", "Yes" });
 			popupMenu->getComboBoxComponent("Save IOP data before parsing")->setSelectedItemIndex(saveIopBeforeParse ? 1 : 0);
+			popupMenu->addTextBlock("Select the format of the CAN log. The compact binary format uses much less disk space, and is converted to .asc when a log package is generated. Only applied on restart.");
+			popupMenu->addComboBox("CAN Log Format", { "Vector ASCII (.asc)", "Compact binary (.cantrace)" });
+			popupMenu->getComboBoxComponent("CAN Log Format")->setSelectedItemIndex(binaryCanLog ? 1 : 0);
 			popupMenu->addButton("OK", 4, KeyPress(KeyPress::returnKey, 0, 0));
 			popupMenu->addButton("Cancel", 0, KeyPress(KeyPress::escapeKey, 0, 0));
 			popupMenu->enterModalState(true, ModalCallbackFunction::create(LanguageCommandConfigClosed{ *this }));
@@ -976,6 +949,19 @@ bool ServerMainComponent::perform(const InvocationInfo &info)
 		}
 		break;
 
+		case static_cast<int>(CommandIDs::ConfigureObjectPoolStorage):
+		{
+			popupMenu = std::make_unique<AlertWindow>("Configure Saved Object Pools", "", MessageBoxIconType::NoIcon);
+			popupMenu->addTextBlock("Compress object pools that clients save. This reduces disk space and wear, especially for pools with large pictures, but takes extra time when a client saves a pool. Pools that are already saved are not changed, and can be loaded either way.");
+			popupMenu->addComboBox("Compress saved object pools", { "No", "Yes" });
+			popupMenu->getComboBoxComponent("Compress saved object pools")->setSelectedItemIndex(compressObjectPools ? 1 : 0);
+			popupMenu->addButton("OK", 6, KeyPress(KeyPress::returnKey, 0, 0));
+			popupMenu->addButton("Cancel", 0, KeyPress(KeyPress::escapeKey, 0, 0));
+			popupMenu->enterModalState(true, ModalCallbackFunction::create(LanguageCommandConfigClosed{ *this }));
+			retVal = true;
+		}
+		break;
+
 		case static_cast<int>(CommandIDs::ConfigureShortcuts):
 		{
 			popupMenu = std::make_unique<AckSettingsWindow>(alarmAckKeyCode, showAckButton);
@@ -986,6 +972,7 @@ bool ServerMainComponent::perform(const InvocationInfo &info)
 
 		case static_cast<int>(CommandIDs::GenerateLogPackage):
 		{
+			OwnedArray<TemporaryFile> convertedTraces; // Deleted once the package has been written
 			auto diagnosticFileBuilder = std::make_unique<ZipFile::Builder>();
 			bool anyFilesAdded = false;
 
@@ -994,23 +981,23 @@ bool ServerMainComponent::perform(const InvocationInfo &info)
 			for (auto &file : userDataFiles)
 			{
 				auto fileExtension = file.getFileExtension();
-				if (fileExtension != ".zip")
+				if (fileExtension == CANTraceFile::FILE_EXTENSION)
+				{
+					add_can_trace_to_package(*diagnosticFileBuilder, file, convertedTraces);
+					anyFilesAdded = true;
+				}
+				else if (fileExtension != ".zip")
 				{
 					diagnosticFileBuilder->addFile(file, 9);
 					anyFilesAdded = true;
 				}
 			}
 
-			auto isoDataDirectory = userDataFolder.getChildFile("iso_data").findChildFiles(File::TypesOfFileToFind::findDirectories, false, "*");
+			storageWorker.wait_until_idle();
 
-			for (auto &iop_directory : isoDataDirectory)
+			if (poolStorage.add_to_package(*diagnosticFileBuilder, [](const String &) { return true; }))
 			{
-				auto iopFiles = iop_directory.findChildFiles(File::TypesOfFileToFind::findFiles, false, "*.iop");
-				for (auto &iopFile : iopFiles)
-				{
-					diagnosticFileBuilder->addFile(iopFile, 9, "iso_data/" + iop_directory.getFileName() + "/" + iopFile.getFileName());
-					anyFilesAdded = true;
-				}
+				anyFilesAdded = true;
 			}
 
 			if (anyFilesAdded)
@@ -1041,13 +1028,22 @@ bool ServerMainComponent::perform(const InvocationInfo &info)
 
 		case static_cast<int>(CommandIDs::GenerateLogPackageFromCurrentSession):
 		{
+			OwnedArray<TemporaryFile> convertedTraces; // Deleted once the package has been written
 			auto diagnosticFileBuilder = std::make_unique<ZipFile::Builder>();
 
 			// for the current session add the current CAN log file only
 			auto canLogFileName = File(canLogPath);
-			diagnosticFileBuilder->addFile(canLogFileName, 9, canLogFileName.getFileName());
+			if (canLogFileName.hasFileExtension(CANTraceFile::FILE_EXTENSION))
+			{
+				add_can_trace_to_package(*diagnosticFileBuilder, canLogFileName, convertedTraces);
+			}
+			else
+			{
+				diagnosticFileBuilder->addFile(canLogFileName, 9, canLogFileName.getFileName());
+			}
 
 			// Cut the output logging where we started
+			logger.flush_log_file();
 			FileInputStream *fis = new FileInputStream(logger.getLogFile());
 			if (fis->openedOk())
 			{
@@ -1055,20 +1051,10 @@ bool ServerMainComponent::perform(const InvocationInfo &info)
 				diagnosticFileBuilder->addEntry(fis, 9, "AgISOVirtualTerminalLog.txt", Time::getCurrentTime());
 			}
 
-			auto userDataFolder = File(File::getSpecialLocation(File::userApplicationDataDirectory).getFullPathName() + File::getSeparatorString() + "Open-Agriculture" + File::getSeparatorString());
-
-			auto iopDirs = userDataFolder.getChildFile("iso_data").findChildFiles(File::TypesOfFileToFind::findDirectories, false, "*");
-			for (auto &iopDir : iopDirs)
-			{
-				if (loadedNames.find(iopDir.getFileName().toStdString()) != loadedNames.end())
-				{
-					auto childFiles = iopDir.findChildFiles(File::TypesOfFileToFind::findFiles, false, "*.iop");
-					for (auto &file : childFiles)
-					{
-						diagnosticFileBuilder->addFile(file, 9, "iso_data/" + iopDir.getFileName().toStdString() + "/" + file.getFileName().toStdString());
-					}
-				}
-			}
+			storageWorker.wait_until_idle();
+			poolStorage.add_to_package(*diagnosticFileBuilder, [this](const String &clientDirectoryName) {
+				return loadedNames.find(clientDirectoryName.toStdString()) != loadedNames.end();
+			});
 
 			auto currentTime = Time::getCurrentTime().toString(true, true, true, false);
 			currentTime = currentTime.replaceCharacter(' ', '_');
@@ -1149,10 +1135,7 @@ bool ServerMainComponent::perform(const InvocationInfo &info)
 			}
 			else
 			{
-				isobus::CANStackLogger::info("Starting CAN interface");
-				isobus::CANHardwareInterface::start();
-				dataMaskRenderer.set_has_started(true);
-				hasStartBeenCalled = true;
+				start_can_interface();
 			}
 			mCommandManager.commandStatusChanged();
 			retVal = true;
@@ -1168,6 +1151,22 @@ bool ServerMainComponent::perform(const InvocationInfo &info)
 		}
 		break;
 
+		case static_cast<int>(CommandIDs::ShowLatencyOverlay):
+		{
+			showLatencyOverlay = !showLatencyOverlay;
+			mCommandManager.commandStatusChanged();
+			repaint(dataMaskRenderer.getBounds());
+			retVal = true;
+		}
+		break;
+
+		case static_cast<int>(CommandIDs::SaveLatencyReport):
+		{
+			save_latency_report();
+			retVal = true;
+		}
+		break;
+
 		default:
 			break;
 	}
@@ -1198,6 +1197,7 @@ PopupMenu ServerMainComponent::getMenuForIndex(int index, const juce::String &)
 			retVal.addCommandItem(&mCommandManager, static_cast<int>(CommandIDs::ConfigureReportedVersion));
 			retVal.addCommandItem(&mCommandManager, static_cast<int>(CommandIDs::ConfigureReportedHardware));
 			retVal.addCommandItem(&mCommandManager, static_cast<int>(CommandIDs::ConfigureLogging));
+			retVal.addCommandItem(&mCommandManager, static_cast<int>(CommandIDs::ConfigureObjectPoolStorage));
 			retVal.addCommandItem(&mCommandManager, static_cast<int>(CommandIDs::ConfigureShortcuts));
 
 #ifdef JUCE_WINDOWS
@@ -1213,6 +1213,8 @@ PopupMenu ServerMainComponent::getMenuForIndex(int index, const juce::String &)
 			retVal.addCommandItem(&mCommandManager, static_cast<int>(CommandIDs::GenerateLogPackage));
 			retVal.addCommandItem(&mCommandManager, static_cast<int>(CommandIDs::GenerateLogPackageFromCurrentSession));
 			retVal.addCommandItem(&mCommandManager, static_cast<int>(CommandIDs::ClearISOData));
+			retVal.addCommandItem(&mCommandManager, static_cast<int>(CommandIDs::ShowLatencyOverlay));
+			retVal.addCommandItem(&mCommandManager, static_cast<int>(CommandIDs::SaveLatencyReport));
 		}
 		break;
 
@@ -1279,6 +1281,13 @@ void ServerMainComponent::change_selected_working_set(std::uint8_t index)
 		std::uint16_t previousActiveMask = activeWorkingSetDataMaskObjectID;
 		activeWorkingSetDataMaskObjectID = std::static_pointer_cast<isobus::WorkingSet>(ws->get_working_set_object())->get_active_mask();
 
+		// Repaint events are only tracked for the active working set, so its cached masks may be out of date
+		JuceManagedWorkingSetCache::invalidate(ws);
+
+		if (objectChangeTracker.take_changes(ws->get_control_function()).paletteChanged)
+		{
+			PictureGraphicCache::on_palette_changed(ws);
+		}
 		dataMaskRenderer.on_change_active_mask(ws);
 		softKeyMaskRenderer.on_change_active_mask(ws);
 		activeWorkingSet = ws;
@@ -1324,6 +1333,7 @@ void ServerMainComponent::set_button_held(std::shared_ptr<isobus::VirtualTermina
 	{
 		heldButtons.push_back(buttonData);
 	}
+	schedule_next_update();
 }
 
 void ServerMainComponent::set_button_released(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet, std::uint16_t objectID, std::uint16_t maskObjectID, std::uint8_t keyCode, bool isSoftKey)
@@ -1340,7 +1350,19 @@ void ServerMainComponent::set_button_released(std::shared_ptr<isobus::VirtualTer
 
 void ServerMainComponent::repaint_on_next_update()
 {
-	needToRepaint = true;
+	if (MessageManager::existsAndIsCurrentThread())
+	{
+		// Changes made from the GUI, such as by macros run when an input is edited, aren't seen by the change tracker
+		needToRebuildMasks = true;
+		needToRepaint = true;
+	}
+	else
+	{
+		uiCommands.push({ UICommand::Type::ValueChange, nullptr, isobus::NULL_OBJECT_ID });
+	}
+
+	// Repaint requests from the CAN stack's thread arrive in bursts, which this coalesces into one update
+	triggerAsyncUpdate();
 }
 
 void ServerMainComponent::LanguageCommandConfigClosed::operator()(int result) const noexcept
@@ -1440,6 +1462,7 @@ void ServerMainComponent::LanguageCommandConfigClosed::operator()(int result) co
 			}
 
 			mParent.saveIopBeforeParse = (mParent.popupMenu->getComboBoxComponent("Save IOP data before parsing")->getSelectedItemIndex() == 1);
+			mParent.binaryCanLog = (mParent.popupMenu->getComboBoxComponent("CAN Log Format")->getSelectedItemIndex() == 1);
 			mParent.save_settings();
 		}
 		break;
@@ -1454,6 +1477,14 @@ void ServerMainComponent::LanguageCommandConfigClosed::operator()(int result) co
 		}
 		break;
 
+		case 6: // Saved object pool storage
+		{
+			mParent.compressObjectPools = (mParent.popupMenu->getComboBoxComponent("Compress saved object pools")->getSelectedItemIndex() == 1);
+			mParent.poolStorage.set_compression_enabled(mParent.compressObjectPools);
+			mParent.save_settings();
+		}
+		break;
+
 		default:
 		{
 			// Cancel. Do nothing
@@ -1518,20 +1549,6 @@ ServerMainComponent::VTVersion ServerMainComponent::get_version_from_setting(std
 	return retVal;
 }
 
-std::size_t ServerMainComponent::number_of_iop_files_in_directory(std::filesystem::path path)
-{
-	std::size_t retVal = 0;
-
-	for (const auto &entry : std::filesystem::directory_iterator(path))
-	{
-		if (entry.path().has_extension() && entry.path().extension() == ".iop")
-		{
-			retVal++;
-		}
-	}
-	return retVal;
-}
-
 bool ServerMainComponent::timeAndDateCallback(isobus::TimeDateInterface::TimeAndDate &timeAndDate)
 {
 	auto now = std::chrono::system_clock::now();
@@ -1558,6 +1575,10 @@ bool ServerMainComponent::timeAndDateCallback(isobus::TimeDateInterface::TimeAnd
 
 void ServerMainComponent::transferred_object_pool_parse_start(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> &workingSet) const
 {
+	poolParsePending = true;
+
+	parseStartPoster.triggerAsyncUpdate();
+
 	if (!saveIopBeforeParse)
 	{
 		return;
@@ -1580,10 +1601,39 @@ void ServerMainComponent::transferred_object_pool_parse_start(std::shared_ptr<is
 
 void ServerMainComponent::on_change_active_mask_callback(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> affectedWorkingSet, std::uint16_t, std::uint16_t newMask)
 {
-	if (isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Joined == affectedWorkingSet->get_object_pool_processing_state())
+	uiCommands.push({ UICommand::Type::ChangeActiveMask, affectedWorkingSet, newMask });
+	triggerAsyncUpdate();
+}
+
+void ServerMainComponent::drain_ui_commands()
+{
+	UICommand command;
+
+	while (uiCommands.pop(command))
 	{
-		const MessageManagerLock mmLock;
+		switch (command.type)
+		{
+			case UICommand::Type::ValueChange:
+			{
+				needToRepaint = true;
+			}
+			break;
 
+			case UICommand::Type::ChangeActiveMask:
+			{
+				apply_active_mask_change(command.workingSet, command.maskObjectID);
+			}
+			break;
+		}
+	}
+}
+
+void ServerMainComponent::apply_active_mask_change(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> affectedWorkingSet, std::uint16_t newMask)
+{
+	if (isobus::VirtualTerminalServerManagedWorkingSet::ObjectPoolProcessingThreadState::Joined == affectedWorkingSet->get_object_pool_processing_state())
+	{
+		// Mask changes skip the change tracker, so this is where they are noticed
+		latencyMonitor.on_changes_noticed(affectedWorkingSet->get_control_function());
 		dataMaskRenderer.on_change_active_mask(activeWorkingSet);
 		softKeyMaskRenderer.on_change_active_mask(activeWorkingSet);
 
@@ -1651,7 +1701,49 @@ void ServerMainComponent::on_change_active_mask_callback(std::shared_ptr<isobus:
 	}
 }
 
+void ServerMainComponent::update_changed_objects()
+{
+	ObjectChangeTracker::Changes changes;
+
+	if (nullptr != activeWorkingSet)
+	{
+		changes = objectChangeTracker.take_changes(activeWorkingSet->get_control_function());
+		latencyMonitor.on_changes_noticed(activeWorkingSet->get_control_function());
+		dataMaskRenderer.on_objects_changed(changes.objectIDs);
+		softKeyMaskRenderer.on_objects_changed(changes.objectIDs);
+
+		if (changes.paletteChanged)
+		{
+			PictureGraphicCache::on_palette_changed(activeWorkingSet);
+		}
+	}
+
+	if (needToRebuildMasks ||
+	    changes.changedUnknownObjects ||
+	    changes.paletteChanged)
+	{
+		// Changes made from the GUI, macros, and palette changes may have touched any cached mask
+		needToRebuildMasks = false;
+		repaint_data_and_soft_key_mask();
+	}
+	else if (dataMaskRenderer.needsRepaint() ||
+	         (!changes.hasCommands) ||
+	         changes.requiresFullRebuild ||
+	         (!JuceManagedWorkingSetCache::update_components(activeWorkingSet, changes.objectIDs)))
+	{
+		// Masks that aren't shown and don't draw any of the changed objects stay cached
+		JuceManagedWorkingSetCache::invalidate(activeWorkingSet, changes.objectIDs);
+		rebuild_data_and_soft_key_mask();
+	}
+}
+
 void ServerMainComponent::repaint_data_and_soft_key_mask()
+{
+	JuceManagedWorkingSetCache::invalidate(activeWorkingSet);
+	rebuild_data_and_soft_key_mask();
+}
+
+void ServerMainComponent::rebuild_data_and_soft_key_mask()
 {
 	dataMaskRenderer.on_change_active_mask(activeWorkingSet);
 	softKeyMaskRenderer.on_change_active_mask(activeWorkingSet);
@@ -1829,6 +1921,23 @@ void ServerMainComponent::check_load_settings(std::shared_ptr<ValueTree> setting
 			{
 				saveIopBeforeParse = false;
 			}
+
+			if (!child.getProperty("CANLogFormat").isVoid())
+			{
+				binaryCanLog = static_cast<int>(child.getProperty("CANLogFormat")) != 0;
+			}
+			else
+			{
+				binaryCanLog = false;
+			}
+		}
+		else if (Identifier("Storage") == child.getType())
+		{
+			if (!child.getProperty("CompressObjectPools").isVoid())
+			{
+				compressObjectPools = static_cast<int>(child.getProperty("CompressObjectPools")) != 0;
+			}
+			poolStorage.set_compression_enabled(compressObjectPools);
 		}
 		else if (Identifier("Control") == child.getType())
 		{
@@ -1892,6 +2001,7 @@ void ServerMainComponent::save_settings()
 		ValueTree hardwareSettings("Hardware");
 		ValueTree loggingSettings("Logging");
 		ValueTree controlSettings("Control");
+		ValueTree storageSettings("Storage");
 
 		std::uint32_t hardwareDriverIndex = 0xFFFFFFFF;
 
@@ -1938,14 +2048,17 @@ void ServerMainComponent::save_settings()
 		loggingSettings.setProperty("Level", static_cast<int>(isobus::CANStackLogger::get_log_level()), nullptr);
 		loggingSettings.setProperty("Shown", static_cast<int>(logger.isVisible()), nullptr);
 		loggingSettings.setProperty("SaveIopBeforeParse", static_cast<int>(saveIopBeforeParse), nullptr);
+		loggingSettings.setProperty("CANLogFormat", static_cast<int>(binaryCanLog), nullptr);
 		controlSettings.setProperty("AutoStart", autostart, nullptr);
 		controlSettings.setProperty("AlarmAckKey", alarmAckKeyCode, nullptr);
 		controlSettings.setProperty("ShowAckButton", showAckButton, nullptr);
+		storageSettings.setProperty("CompressObjectPools", static_cast<int>(compressObjectPools), nullptr);
 		settings.appendChild(languageCommandSettings, nullptr);
 		settings.appendChild(compatibilitySettings, nullptr);
 		settings.appendChild(hardwareSettings, nullptr);
 		settings.appendChild(loggingSettings, nullptr);
 		settings.appendChild(controlSettings, nullptr);
+		settings.appendChild(storageSettings, nullptr);
 		std::unique_ptr<XmlElement> xml(settings.createXml());
 
 		if (nullptr != xml)
@@ -2052,12 +2165,7 @@ void ServerMainComponent::screen_capture(std::uint8_t item, std::uint8_t path, s
 		return;
 	}
 
-	Image image(Image::PixelFormat::ARGB, dataMaskRenderer.getWidth() + softKeyMaskRenderer.getWidth(), dataMaskRenderer.getHeight(), true);
-	Graphics g(image);
-	paint(g);
-	juce::AffineTransform t;
-	g.addTransform(t.translated(-dataMaskRenderer.getX(), -dataMaskRenderer.getY()));
-	paintEntireComponent(g, false);
+	auto image = render_masks_to_image();
 
 	PNGImageFormat pngFormat;
 	std::unique_ptr<FileOutputStream> stream(saveFile.createOutputStream());
@@ -2075,6 +2183,29 @@ void ServerMainComponent::screen_capture(std::uint8_t item, std::uint8_t path, s
 	send_capture_screen_response(item, path, error, saveFileIndex, requestor);
 }
 
+Image ServerMainComponent::render_masks_to_image()
+{
+	Image image(Image::PixelFormat::ARGB, dataMaskRenderer.getWidth() + softKeyMaskRenderer.getWidth(), dataMaskRenderer.getHeight(), true);
+	Graphics g(image);
+	paint(g);
+	juce::AffineTransform t;
+	g.addTransform(t.translated(-dataMaskRenderer.getX(), -dataMaskRenderer.getY()));
+	paintEntireComponent(g, false);
+	return image;
+}
+
+void ServerMainComponent::start_can_interface()
+{
+	if (!hasStartBeenCalled)
+	{
+		isobus::CANStackLogger::info("Starting CAN interface");
+		isobus::CANHardwareInterface::start();
+		dataMaskRenderer.set_has_started(true);
+		hasStartBeenCalled = true;
+		mCommandManager.commandStatusChanged();
+	}
+}
+
 int ServerMainComponent::minimum_height() const
 {
 	if (dataMaskRenderer.getHeight() > softKeyMaskDimensions.total_height())
@@ -2085,6 +2216,9 @@ int ServerMainComponent::minimum_height() const
 void ServerMainComponent::remove_working_set(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSetToRemove)
 {
 	loadVersionResponsesSent.erase(workingSetToRemove.get());
+	JuceManagedWorkingSetCache::remove_working_set(workingSetToRemove);
+	objectChangeTracker.clear_changes(workingSetToRemove->get_control_function());
+	PictureGraphicCache::remove_working_set(workingSetToRemove);
 	for (auto it = managedWorkingSetList.begin(); it != managedWorkingSetList.end(); it++)
 	{
 		if (workingSetToRemove == *it)
@@ -2098,15 +2232,91 @@ void ServerMainComponent::remove_working_set(std::shared_ptr<isobus::VirtualTerm
 
 void ServerMainComponent::clear_iso_data()
 {
-	File isoDirectory(getAppDataDir() +
-	                  File::getSeparatorString() +
-	                  ISO_DATA_PATH +
-	                  File::getSeparatorString());
+	storageWorker.clear();
+}
+
+void ServerMainComponent::report_storage_completions()
+{
+	for (const auto &completion : storageWorker.take_completions())
+	{
+		std::ostringstream nameString;
+		nameString << std::hex << std::setfill('0') << std::setw(16) << completion.clientNAME.get_full_name();
+		auto versionLabel = String::toHexString(completion.versionLabel.data(), static_cast<int>(completion.versionLabel.size()), 0).toStdString();
+
+		switch (completion.operation)
+		{
+			case ObjectPoolStorageWorker::Operation::SaveVersion:
+			{
+				if (!completion.succeeded)
+				{
+					isobus::CANStackLogger::error("[VT Server]: Failed to save object pool version " + versionLabel + " for client " + nameString.str());
+				}
+			}
+			break;
+
+			case ObjectPoolStorageWorker::Operation::DeleteVersion:
+			{
+				if (completion.succeeded)
+				{
+					isobus::CANStackLogger::info("[VT Server]: Deleted object pool version " + versionLabel + " for client " + nameString.str());
+				}
+				else
+				{
+					isobus::CANStackLogger::warn("[VT Server]: Failed to delete all files of object pool version " + versionLabel + " for client " + nameString.str());
+				}
+			}
+			break;
+
+			case ObjectPoolStorageWorker::Operation::DeleteAllVersions:
+			{
+				if (completion.succeeded)
+				{
+					isobus::CANStackLogger::info("[VT Server]: Deleted all object pool versions for client " + nameString.str());
+				}
+				else
+				{
+					isobus::CANStackLogger::warn("[VT Server]: Failed to delete all object pool files for client " + nameString.str());
+				}
+			}
+			break;
+
+			case ObjectPoolStorageWorker::Operation::Clear:
+			{
+				if (completion.succeeded)
+				{
+					isobus::CANStackLogger::info("ISO Data cleared");
+				}
+			}
+			break;
+		}
+	}
+}
+
+void ServerMainComponent::add_can_trace_to_package(ZipFile::Builder &packageBuilder, const File &traceFile, OwnedArray<TemporaryFile> &convertedTraces)
+{
+	// Traces are converted so that whoever reads the package can open them with the usual CAN tools.
+	// The text is streamed to a temporary file rather than held in memory, since traces are the largest files in a package.
+	auto ascFile = std::make_unique<TemporaryFile>(".asc");
+	auto ascStream = ascFile->getFile().createOutputStream();
+	bool converted = (nullptr != ascStream) && ascStream->openedOk() && CANTraceFile::export_to_asc(traceFile, *ascStream);
 
-	if (isoDirectory.exists() && isoDirectory.isDirectory())
+	if (nullptr != ascStream)
 	{
-		isoDirectory.deleteRecursively();
-		isobus::CANStackLogger::info("ISO Data cleared");
+		ascStream->flush();
+		converted = converted && (!ascStream->getStatus().failed());
+		ascStream.reset();
+	}
+
+	if (converted)
+	{
+		ascFile->getFile().setLastModificationTime(traceFile.getLastModificationTime());
+		packageBuilder.addFile(ascFile->getFile(), 9, traceFile.withFileExtension(".asc").getFileName());
+		convertedTraces.add(ascFile.release());
+	}
+	else
+	{
+		isobus::CANStackLogger::warn("[VT Server]: Could not convert CAN trace " + traceFile.getFileName().toStdString() + " to .asc, adding it as is");
+		packageBuilder.addFile(traceFile, 9);
 	}
 }
 
@@ -2114,3 +2324,51 @@ std::string ServerMainComponent::getAppDataDir()
 {
 	return juce::String(File::getSpecialLocation(File::userApplicationDataDirectory).getFullPathName() + File::getSeparatorString() + "Open-Agriculture").toStdString();
 }
+
+void ServerMainComponent::draw_latency_overlay(juce::Graphics &g)
+{
+	constexpr int LINE_HEIGHT = 14;
+	auto statistics = latencyMonitor.get_statistics();
+	auto area = dataMaskRenderer.getBounds().reduced(4).withHeight(LINE_HEIGHT * (static_cast<int>(statistics.size()) + 1) + 8);
+
+	g.setColour(juce::Colours::black.withAlpha(0.75f));
+	g.fillRect(area);
+	g.setColour(juce::Colours::white);
+	g.setFont(juce::FontOptions(juce::Font::getDefaultMonospacedFontName(), 11.0f, juce::Font::plain));
+	area.reduce(4, 4);
+
+	// Each line is the time until the change was noticed, then until it was painted, in milliseconds
+	g.drawText("Command (count)  noticed p50/p95/p99  painted p50/p95/p99 ms", area.removeFromTop(LINE_HEIGHT), juce::Justification::centredLeft);
+
+	for (const auto &command : statistics)
+	{
+		auto line = LatencyMonitor::get_command_name(command.functionCode) +
+		  " (" + String(command.sampleCount) + ")  " +
+		  String(command.noticed.p50, 1) + "/" + String(command.noticed.p95, 1) + "/" + String(command.noticed.p99, 1) + "  " +
+		  String(command.painted.p50, 1) + "/" + String(command.painted.p95, 1) + "/" + String(command.painted.p99, 1);
+		g.drawText(line, area.removeFromTop(LINE_HEIGHT), juce::Justification::centredLeft);
+	}
+}
+
+void ServerMainComponent::save_latency_report()
+{
+	auto currentTime = Time::getCurrentTime().toString(true, true, true, false);
+	currentTime = currentTime.replaceCharacter(' ', '_');
+	currentTime = currentTime.replaceCharacter(':', '_');
+	auto reportFile = File(getAppDataDir()).getChildFile("AgISOVirtualTerminalLatency_" + currentTime + ".csv");
+
+	if (latencyMonitor.write_csv(reportFile))
+	{
+		isobus::CANStackLogger::info("[VT Server]: Saved command latency report to " + reportFile.getFullPathName().toStdString());
+		reportFile.revealToUser();
+	}
+	else
+	{
+		AlertWindow::showAsync(MessageBoxOptions()
+		                         .withIconType(MessageBoxIconType::WarningIcon)
+		                         .withTitle("Export Failed")
+		                         .withMessage("The command latency report could not be written to " + reportFile.getFullPathName())
+		                         .withButton("OK"),
+		                       nullptr);
+	}
+}
@@ -55,7 +55,10 @@ bool Settings::load_settings()
 						{
 							m_vtNumber = 1;
 						}
-						break;
+					}
+					else if (Identifier("Logging") == child.getType() && !child.getProperty("CANLogFormat").isVoid())
+					{
+						m_binaryCanLog = static_cast<int>(child.getProperty("CANLogFormat")) != 0;
 					}
 					index++;
 					child = m_settings->getChild(index);
@@ -77,3 +80,8 @@ int Settings::vt_number() const
 {
 	return m_vtNumber;
 }
+
+bool Settings::binary_can_log() const
+{
+	return m_binaryCanLog;
+}
@@ -15,8 +15,11 @@ SoftKeyMaskRenderAreaComponent::SoftKeyMaskRenderAreaComponent(ServerMainCompone
 
 void SoftKeyMaskRenderAreaComponent::on_change_active_mask(std::shared_ptr<isobus::VirtualTerminalServerManagedWorkingSet> workingSet)
 {
+	// Masks are owned by the component cache, so they need to be detached rather than destroyed
+	removeAllChildren();
 	childComponents.clear();
 	parentWorkingSet = workingSet;
+	hitTestEngine.set_working_set(parentWorkingSet);
 
 	if (parentWorkingSet)
 	{
@@ -34,8 +37,12 @@ void SoftKeyMaskRenderAreaComponent::on_change_active_mask(std::shared_ptr<isobu
 
 					if ((nullptr != child) && (isobus::VirtualTerminalObjectType::SoftKeyMask == child->get_object_type()))
 					{
-						childComponents.emplace_back(JuceManagedWorkingSetCache::create_component(parentWorkingSet, child));
-						addAndMakeVisible(*childComponents.back());
+						childComponents.emplace_back(JuceManagedWorkingSetCache::get_mask_component(parentWorkingSet, child));
+
+						if (nullptr != childComponents.back())
+						{
+							addAndMakeVisible(*childComponents.back());
+						}
 					}
 				}
 				else if (isobus::VirtualTerminalObjectType::DataMask == activeMask->get_object_type())
@@ -44,8 +51,12 @@ void SoftKeyMaskRenderAreaComponent::on_change_active_mask(std::shared_ptr<isobu
 
 					if ((nullptr != child) && (isobus::VirtualTerminalObjectType::SoftKeyMask == child->get_object_type()))
 					{
-						childComponents.emplace_back(JuceManagedWorkingSetCache::create_component(parentWorkingSet, child));
-						addAndMakeVisible(*childComponents.back());
+						childComponents.emplace_back(JuceManagedWorkingSetCache::get_mask_component(parentWorkingSet, child));
+
+						if (nullptr != childComponents.back())
+						{
+							addAndMakeVisible(*childComponents.back());
+						}
 					}
 				}
 			}
@@ -59,11 +70,18 @@ void SoftKeyMaskRenderAreaComponent::on_working_set_disconnect(std::shared_ptr<i
 	if ((nullptr != workingSet) && (workingSet == parentWorkingSet))
 	{
 		parentWorkingSet = nullptr;
+		hitTestEngine.set_working_set(nullptr);
+		removeAllChildren();
 		childComponents.clear();
 		repaint();
 	}
 }
 
+void SoftKeyMaskRenderAreaComponent::on_objects_changed(const std::set<std::uint16_t> &objectIDs)
+{
+	hitTestEngine.on_objects_changed(objectIDs);
+}
+
 void SoftKeyMaskRenderAreaComponent::paint(Graphics &g)
 {
 	g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
@@ -78,35 +96,16 @@ void SoftKeyMaskRenderAreaComponent::mouseDown(const MouseEvent &event)
 {
 	if (nullptr != parentWorkingSet)
 	{
-		// Do a top down search to see if they clicked on some interactable object
+		// Look up the key they clicked on, if any
+		update_soft_key_layout();
 		auto workingSetObject = std::static_pointer_cast<isobus::WorkingSet>(parentWorkingSet->get_working_set_object());
+		auto activeMask = hitTestEngine.get_displayed_mask();
 
-		if (nullptr != workingSetObject)
+		if ((nullptr != workingSetObject) && (nullptr != activeMask))
 		{
-			auto activeMask = parentWorkingSet->get_object_by_id(workingSetObject->get_active_mask());
-			auto parentMask = activeMask;
-
-			if (isobus::VirtualTerminalObjectType::AlarmMask == activeMask->get_object_type())
-			{
-				auto child = activeMask->get_object_by_id(std::static_pointer_cast<isobus::AlarmMask>(activeMask)->get_soft_key_mask(), parentWorkingSet->get_object_tree());
-
-				if ((nullptr != child) && (isobus::VirtualTerminalObjectType::SoftKeyMask == child->get_object_type()))
-				{
-					activeMask = child;
-				}
-			}
-			else if (isobus::VirtualTerminalObjectType::DataMask == activeMask->get_object_type())
-			{
-				auto child = activeMask->get_object_by_id(std::static_pointer_cast<isobus::DataMask>(activeMask)->get_soft_key_mask(), parentWorkingSet->get_object_tree());
-
-				if ((nullptr != child) && (isobus::VirtualTerminalObjectType::SoftKeyMask == child->get_object_type()))
-				{
-					activeMask = child;
-				}
-			}
-
+			auto parentMask = parentWorkingSet->get_object_by_id(workingSetObject->get_active_mask());
 			auto relativeEvent = event.getEventRelativeTo(this);
-			auto clickedObject = getClickedChildRecursive(activeMask, relativeEvent.getMouseDownX(), relativeEvent.getMouseDownY());
+			auto clickedObject = hitTestEngine.find(relativeEvent.getMouseDownX(), relativeEvent.getMouseDownY());
 
 			ownerServer.process_macro(clickedObject, isobus::EventID::OnKeyPress, isobus::VirtualTerminalObjectType::Key, parentWorkingSet);
 
@@ -138,35 +137,16 @@ void SoftKeyMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 {
 	if (nullptr != parentWorkingSet)
 	{
-		// Do a top down search to see if they clicked on some interactable object
+		// Look up the key they clicked on, if any
+		update_soft_key_layout();
 		auto workingSetObject = std::static_pointer_cast<isobus::WorkingSet>(parentWorkingSet->get_working_set_object());
+		auto activeMask = hitTestEngine.get_displayed_mask();
 
-		if (nullptr != workingSetObject)
+		if ((nullptr != workingSetObject) && (nullptr != activeMask))
 		{
-			auto activeMask = parentWorkingSet->get_object_by_id(workingSetObject->get_active_mask());
-			auto parentMask = activeMask;
-
-			if (isobus::VirtualTerminalObjectType::AlarmMask == activeMask->get_object_type())
-			{
-				auto child = activeMask->get_object_by_id(std::static_pointer_cast<isobus::AlarmMask>(activeMask)->get_soft_key_mask(), parentWorkingSet->get_object_tree());
-
-				if ((nullptr != child) && (isobus::VirtualTerminalObjectType::SoftKeyMask == child->get_object_type()))
-				{
-					activeMask = child;
-				}
-			}
-			else if (isobus::VirtualTerminalObjectType::DataMask == activeMask->get_object_type())
-			{
-				auto child = activeMask->get_object_by_id(std::static_pointer_cast<isobus::DataMask>(activeMask)->get_soft_key_mask(), parentWorkingSet->get_object_tree());
-
-				if ((nullptr != child) && (isobus::VirtualTerminalObjectType::SoftKeyMask == child->get_object_type()))
-				{
-					activeMask = child;
-				}
-			}
-
+			auto parentMask = parentWorkingSet->get_object_by_id(workingSetObject->get_active_mask());
 			auto relativeEvent = event.getEventRelativeTo(this);
-			auto clickedObject = getClickedChildRecursive(activeMask, relativeEvent.getPosition().x, relativeEvent.getPosition().y);
+			auto clickedObject = hitTestEngine.find(relativeEvent.getPosition().x, relativeEvent.getPosition().y);
 
 			ownerServer.process_macro(clickedObject, isobus::EventID::OnKeyRelease, isobus::VirtualTerminalObjectType::Key, parentWorkingSet);
 
@@ -194,97 +174,11 @@ void SoftKeyMaskRenderAreaComponent::mouseUp(const MouseEvent &event)
 	}
 }
 
-std::shared_ptr<isobus::VTObject> SoftKeyMaskRenderAreaComponent::getClickedChildRecursive(std::shared_ptr<isobus::VTObject> object, int x, int y)
-{
-	std::shared_ptr<isobus::VTObject> retVal;
-
-	if ((nullptr == object) ||
-	    ((isobus::VirtualTerminalObjectType::ObjectPointer != object->get_object_type()) &&
-	     (0 == object->get_number_children())))
-	{
-		return nullptr;
-	}
-
-	if (isobus::VirtualTerminalObjectType::ObjectPointer == object->get_object_type())
-	{
-		auto child = object->get_object_by_id(std::static_pointer_cast<isobus::ObjectPointer>(object)->get_value(), parentWorkingSet->get_object_tree());
-
-		// Knowing the location requires some knowledge of how the mask is displaying each key...
-
-		if ((nullptr != child) &&
-		    (objectCanBeClicked(child)) &&
-		    (isClickWithinBounds(x, y, 0, 0, ownerServer.get_soft_key_descriptor_x_pixel_width(), ownerServer.get_soft_key_descriptor_y_pixel_height())))
-		{
-			return child;
-		}
-		else if (!objectCanBeClicked(child))
-		{
-			retVal = getClickedChildRecursive(child, x, y);
-		}
-	}
-	else
-	{
-		int row = 0, col = (ownerServer.get_physical_soft_key_columns() - 1);
-		for (std::uint16_t i = 0; i < object->get_number_children(); i++)
-		{
-			auto child = object->get_object_by_id(object->get_child_id(i), parentWorkingSet->get_object_tree());
-
-			// Knowing the location requires some knowledge of how the mask is displaying each key...
-
-			int colX = SoftKeyMaskDimensions::PADDING + col * (ownerServer.get_soft_key_descriptor_x_pixel_width() + SoftKeyMaskDimensions::PADDING);
-			int rowY = SoftKeyMaskDimensions::PADDING + row * (ownerServer.get_soft_key_descriptor_y_pixel_height() + SoftKeyMaskDimensions::PADDING);
-			if ((nullptr != child) &&
-			    (objectCanBeClicked(child)) &&
-			    (isClickWithinBounds(x, y, colX, rowY, ownerServer.get_soft_key_descriptor_x_pixel_width(), ownerServer.get_soft_key_descriptor_y_pixel_height())))
-			{
-				return child;
-			}
-			else if (!objectCanBeClicked(child))
-			{
-				retVal = getClickedChildRecursive(child, x - colX, y - rowY);
-
-				if (nullptr != retVal)
-				{
-					break;
-				}
-			}
-			row++;
-			if (row >= ownerServer.get_physical_soft_key_rows())
-			{
-				row = 0;
-				col--;
-			}
-		}
-	}
-	return retVal;
-}
-
-bool SoftKeyMaskRenderAreaComponent::objectCanBeClicked(std::shared_ptr<isobus::VTObject> object)
-{
-	bool retVal = false;
-
-	if (nullptr != object)
-	{
-		switch (object->get_object_type())
-		{
-			case isobus::VirtualTerminalObjectType::Key:
-			{
-				retVal = true;
-			}
-			break;
-
-			default:
-			{
-				retVal = false;
-			}
-			break;
-		}
-	}
-	return retVal;
-}
-
-bool SoftKeyMaskRenderAreaComponent::isClickWithinBounds(int clickXRelative, int clickYRelative, int objectX, int objectY, int objectWidth, int objectHeight)
+void SoftKeyMaskRenderAreaComponent::update_soft_key_layout()
 {
-	return ((clickXRelative >= objectX) && (clickXRelative <= (objectX + objectWidth))) &&
-	  ((clickYRelative >= objectY) && (clickYRelative <= (objectY + objectHeight)));
+	// The soft key geometry can be changed in the settings at any time, and the index is only rebuilt if it did change
+	hitTestEngine.set_soft_key_layout(ownerServer.get_soft_key_descriptor_x_pixel_width(),
+	                                  ownerServer.get_soft_key_descriptor_y_pixel_height(),
+	                                  ownerServer.get_physical_soft_key_columns(),
+	                                  ownerServer.get_physical_soft_key_rows());
 }
@@ -120,54 +120,76 @@ std::uint8_t TextDrawingComponent::prepare_text_painting(Graphics &g,
                                                          juce::Colour &drawColour,
                                                          juce::Colour &backgroundColor)
 {
-	std::uint8_t fontHeight;
-	int fontStyleFlags = Font::FontStyleFlags::plain;
+	std::uint8_t fontHeight = font->get_font_height_pixels();
 
-	if (font->get_style(isobus::FontAttributes::FontStyleBits::Bold))
+	if (fontHeight == 0)
 	{
-		fontStyleFlags |= Font::FontStyleFlags::bold;
+		fontHeight = 8;
 	}
 
-	if (font->get_style(isobus::FontAttributes::FontStyleBits::Italic))
+	// swap background and draw colors for inverted draw style
+
+	if (font->get_style(isobus::FontAttributes::FontStyleBits::Inverted) || (font->get_style(isobus::FontAttributes::FontStyleBits::Flashing) && !show))
 	{
-		fontStyleFlags |= Font::FontStyleFlags::italic;
+		auto tmpColor = backgroundColor;
+		backgroundColor = drawColour;
+		drawColour = tmpColor;
 	}
 
-	if (font->get_style(isobus::FontAttributes::FontStyleBits::Underlined))
+	g.setColour(drawColour);
+	g.setFont(get_cached_font(*font, referenceCharForWidthCalc));
+
+	return fontHeight;
+}
+
+Font TextDrawingComponent::get_cached_font(const isobus::FontAttributes &font, char referenceCharForWidthCalc) const
+{
+	int fontStyleFlags = Font::FontStyleFlags::plain;
+
+	if (font.get_style(isobus::FontAttributes::FontStyleBits::Bold))
 	{
-		fontStyleFlags |= Font::FontStyleFlags::underlined;
+		fontStyleFlags |= Font::FontStyleFlags::bold;
 	}
 
-	Font juceFont(FontOptions(Font::getDefaultMonospacedFontName(),
-	                          font->get_font_height_pixels(),
-	                          fontStyleFlags)
-	                .withMetricsKind(juce::TypefaceMetricsKind::legacy));
-
-	auto fontWidth = GlyphArrangement::getStringWidth(juceFont, juce::String::fromUTF8(&referenceCharForWidthCalc, 1));
-	fontHeight = font->get_font_height_pixels();
-	if (fontHeight == 0)
+	if (font.get_style(isobus::FontAttributes::FontStyleBits::Italic))
 	{
-		fontHeight = 8;
+		fontStyleFlags |= Font::FontStyleFlags::italic;
 	}
 
-	if (!approximatelyEqual(fontWidth, 0.0f))
+	if (font.get_style(isobus::FontAttributes::FontStyleBits::Underlined))
 	{
-		juceFont.setHorizontalScale(static_cast<float>(font->get_font_width_pixels()) / fontWidth);
+		fontStyleFlags |= Font::FontStyleFlags::underlined;
 	}
 
-	// swap background and draw colors for inverted draw style
+	// The height, width, JUCE style flags and reference character each fit in a byte
+	const std::uint32_t key = (static_cast<std::uint32_t>(font.get_font_height_pixels()) << 24) |
+	  (static_cast<std::uint32_t>(font.get_font_width_pixels()) << 16) |
+	  (static_cast<std::uint32_t>(fontStyleFlags & 0xFF) << 8) |
+	  static_cast<std::uint8_t>(referenceCharForWidthCalc);
+	auto cachedFont = fontCache->fonts.find(key);
 
-	if (font->get_style(isobus::FontAttributes::FontStyleBits::Inverted) || (font->get_style(isobus::FontAttributes::FontStyleBits::Flashing) && !show))
+	if (fontCache->fonts.end() == cachedFont)
 	{
-		auto tmpColor = backgroundColor;
-		backgroundColor = drawColour;
-		drawColour = tmpColor;
-	}
+		Font juceFont(FontOptions(Font::getDefaultMonospacedFontName(),
+		                          font.get_font_height_pixels(),
+		                          fontStyleFlags)
+		                .withMetricsKind(juce::TypefaceMetricsKind::legacy));
 
-	g.setColour(drawColour);
-	g.setFont(juceFont);
+		auto fontWidth = GlyphArrangement::getStringWidth(juceFont, juce::String::fromUTF8(&referenceCharForWidthCalc, 1));
 
-	return fontHeight;
+		if (!approximatelyEqual(fontWidth, 0.0f))
+		{
+			juceFont.setHorizontalScale(static_cast<float>(font.get_font_width_pixels()) / fontWidth);
+		}
+
+		if (fontCache->fonts.size() >= MAXIMUM_CACHED_FONTS)
+		{
+			// Pools only use a handful of fonts, so this only happens after many pools have come and gone
+			fontCache->fonts.clear();
+		}
+		cachedFont = fontCache->fonts.emplace(key, juceFont).first;
+	}
+	return cachedFont->second;
 }
 
 void TextDrawingComponent::drawStrikeThrough(Graphics &g, int w, int h, const String &str, isobus::TextualVTObject::HorizontalJustification justification)